@@ -0,0 +1,299 @@
+#include "animation.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <ctime>
+
+#include "imagecache.h"
+
+#include <QImage>
+#include <QImageReader>
+#include <QString>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void deleteImage(gpointer image) {
+    delete static_cast<QImage *>(image);
+}
+
+// same as ImageCache::decode, minus the rgb packing since gifs are usually
+// transparent somewhere
+GVariant *frameData(const QImage &frame, std::size_t &size) {
+    QImage *pixels = new QImage(frame.convertToFormat(QImage::Format_RGBA8888));
+    size = static_cast<std::size_t>(pixels->sizeInBytes());
+    GBytes *bytes = g_bytes_new_with_free_func(pixels->constBits(), size, deleteImage, pixels);
+    GVariant *imageData = g_variant_new("(iiibii@ay)",
+        pixels->width(), pixels->height(), static_cast<int>(pixels->bytesPerLine()), TRUE, 8, 4,
+        g_variant_new_from_bytes(G_VARIANT_TYPE_BYTESTRING, bytes, TRUE)
+    );
+    g_bytes_unref(bytes);
+    return g_variant_ref_sink(imageData);
+}
+
+std::shared_ptr<const AnimationFrames> decodeFrames(const char *resourcePath) {
+    QImageReader reader(QString::fromUtf8(resourcePath));
+    if (!reader.supportsAnimation() || reader.imageCount() == 1) {
+        return nullptr;
+    }
+
+    int maxDimension = ImageCache::instance().maxDimension();
+    auto frames = std::make_shared<AnimationFrames>();
+    frames->loopCount = reader.loopCount() < 0 ? 0 : reader.loopCount();
+
+    while (reader.canRead()) {
+        QImage frame = reader.read();
+        if (frame.isNull()) {
+            break;
+        }
+        if (maxDimension > 0 && (frame.width() > maxDimension || frame.height() > maxDimension)) {
+            frame = frame.scaled(maxDimension, maxDimension, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+
+        // browsers treat 0 and 10ms frames as 100ms, gifs out there count on it
+        int delay = reader.nextImageDelay();
+        delay = delay <= 10 ? 100 : delay;
+
+        std::size_t size = 0;
+        frames->frames.push_back(frameData(frame, size));
+        frames->delays.push_back(delay);
+        frames->totalDelay += delay;
+        frames->bytes += size;
+    }
+
+    if (frames->frames.size() < 2) {
+        return nullptr;
+    }
+    return frames;
+}
+
+double threadCpuMs() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+} // namespace
+
+AnimationFrames::~AnimationFrames() {
+    for (GVariant *frame : frames) {
+        g_variant_unref(frame);
+    }
+}
+
+std::shared_ptr<const AnimationFrames> animationFrames(ResourceId id) {
+    static std::mutex mutex;
+    static std::array<std::shared_ptr<const AnimationFrames>, resourceCount> decoded;
+    static std::array<bool, resourceCount> looked{};
+
+    if (id == ResourceId::None) {
+        return nullptr;
+    }
+    std::size_t index = static_cast<std::size_t>(id);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!looked[index]) {
+        // remembers the nullptr too, so still images only get looked at once
+        decoded[index] = decodeFrames(resourcePath(id));
+        looked[index] = true;
+    }
+    return decoded[index];
+}
+
+struct NotificationAnimator::Animation {
+    NotificationAnimator *owner;
+    NotifyNotification *notification;
+    std::shared_ptr<const AnimationFrames> frames;
+    Clock::time_point start;
+    std::size_t current = 0;
+    gulong closedHandler = 0;
+    GSource *source = nullptr;
+    std::atomic<bool> closed{false};
+};
+
+NotificationAnimator &NotificationAnimator::instance() {
+    static NotificationAnimator animator;
+    return animator;
+}
+
+NotificationAnimator::NotificationAnimator()
+    : m_context(g_main_context_new()),
+      m_loop(g_main_loop_new(m_context, FALSE)) {
+    m_thread = std::thread(&NotificationAnimator::run, this);
+}
+
+NotificationAnimator::~NotificationAnimator() {
+    stopAll();
+    g_main_context_invoke(m_context, &NotificationAnimator::quit, m_loop);
+    m_thread.join();
+
+    g_main_loop_unref(m_loop);
+    g_main_context_unref(m_context);
+}
+
+void NotificationAnimator::run() {
+    g_main_context_push_thread_default(m_context);
+    g_main_loop_run(m_loop);
+    g_main_context_pop_thread_default(m_context);
+}
+
+gboolean NotificationAnimator::quit(gpointer loop) {
+    g_main_loop_quit(static_cast<GMainLoop *>(loop));
+    return G_SOURCE_REMOVE;
+}
+
+bool NotificationAnimator::animate(NotifyNotification *n, std::shared_ptr<const AnimationFrames> frames) {
+    auto animation = std::make_unique<Animation>();
+    animation->owner = this;
+    animation->frames = std::move(frames);
+    animation->start = Clock::now();
+
+    // the cap check and the insert are one step or two callers could both
+    // get the last slot, and scheduling in there too means stopAll() cant
+    // finish it halfway through
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running.size() >= maxRunning) {
+        return false;
+    }
+    animation->notification = NOTIFY_NOTIFICATION(g_object_ref(G_OBJECT(n)));
+    animation->closedHandler = g_signal_connect(G_OBJECT(n), "closed", G_CALLBACK(&NotificationAnimator::closed), animation.get());
+    schedule(animation.get(), std::chrono::milliseconds(animation->frames->delays[0]));
+    m_running.push_back(std::move(animation));
+    m_stats.started++;
+    return true;
+}
+
+void NotificationAnimator::closed(NotifyNotification *, gpointer animation) {
+    // comes in on whatever thread libnotify listens on, tick() picks it up
+    static_cast<Animation *>(animation)->closed = true;
+}
+
+void NotificationAnimator::schedule(Animation *animation, std::chrono::milliseconds delay) {
+    animation->source = g_timeout_source_new(static_cast<guint>(std::max<std::chrono::milliseconds::rep>(1, delay.count())));
+    g_source_set_callback(animation->source, &NotificationAnimator::tick, animation, nullptr);
+    g_source_attach(animation->source, m_context);
+}
+
+gboolean NotificationAnimator::tick(gpointer data) {
+    auto *animation = static_cast<Animation *>(data);
+    NotificationAnimator *owner = animation->owner;
+    const AnimationFrames &frames = *animation->frames;
+
+    g_source_unref(animation->source);
+    animation->source = nullptr;
+
+    // the budget is shared between everything thats animating
+    double budget;
+    std::chrono::milliseconds maxDuration;
+    {
+        std::lock_guard<std::mutex> lock(owner->m_mutex);
+        budget = owner->m_cpuBudget / std::max<std::size_t>(1, owner->m_running.size());
+        maxDuration = owner->m_maxDuration;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - animation->start).count();
+    bool loopsDone = frames.loopCount > 0 && elapsed >= static_cast<long long>(frames.loopCount) * frames.totalDelay;
+    if (animation->closed || loopsDone || elapsed >= maxDuration.count()) {
+        owner->finish(animation);
+        return G_SOURCE_REMOVE;
+    }
+
+    // the frame that should be up right now, going by the clock and not by
+    // how many ticks we got, so a slow round trip drops frames instead of
+    // slowing the whole thing down
+    long long position = elapsed % frames.totalDelay;
+    std::size_t target = 0;
+    long long frameEnd = frames.delays[0];
+    while (frameEnd <= position && target + 1 < frames.frames.size()) {
+        target++;
+        frameEnd += frames.delays[target];
+    }
+    long long untilNext = frameEnd - position;
+
+    double cost = 0;
+    if (target != animation->current) {
+        std::size_t count = frames.frames.size();
+        std::size_t skipped = (target + count - animation->current - 1) % count;
+
+        double before = threadCpuMs();
+        // the variants are kept in the frame cache, this only takes a ref
+        notify_notification_set_hint(animation->notification, "image-data", frames.frames[target]);
+        notify_notification_show(animation->notification, nullptr);
+        cost = threadCpuMs() - before;
+        animation->current = target;
+
+        std::lock_guard<std::mutex> lock(owner->m_mutex);
+        owner->m_stats.framesShown++;
+        owner->m_stats.framesDropped += skipped;
+        owner->m_stats.cpuMs += cost;
+    }
+
+    // a frame that cost 2ms with a 5% budget means the next one cant come
+    // sooner than 40ms from now, whatever the gif says
+    long long minimumGap = budget > 0 ? static_cast<long long>(cost / budget) : 0;
+    owner->schedule(animation, std::chrono::milliseconds(std::max(untilNext, minimumGap)));
+    return G_SOURCE_REMOVE;
+}
+
+void NotificationAnimator::finish(Animation *animation) {
+    if (animation->source) {
+        g_source_destroy(animation->source);
+        g_source_unref(animation->source);
+        animation->source = nullptr;
+    }
+    g_signal_handler_disconnect(G_OBJECT(animation->notification), animation->closedHandler);
+    g_object_unref(G_OBJECT(animation->notification));
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running.remove_if([animation](const std::unique_ptr<Animation> &running) {
+            return running.get() == animation;
+        });
+    }
+    m_idle.notify_all();
+}
+
+void NotificationAnimator::setCpuBudget(double fraction) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cpuBudget = fraction;
+}
+
+void NotificationAnimator::setMaxDuration(std::chrono::milliseconds duration) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxDuration = duration;
+}
+
+void NotificationAnimator::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() {
+        return m_running.empty();
+    });
+}
+
+void NotificationAnimator::stopAll() {
+    // finish() has to run on the animator thread, where the ticks run
+    g_main_context_invoke(m_context, [](gpointer self) -> gboolean {
+        auto *animator = static_cast<NotificationAnimator *>(self);
+        std::vector<Animation *> running;
+        {
+            std::lock_guard<std::mutex> lock(animator->m_mutex);
+            for (const auto &animation : animator->m_running) {
+                running.push_back(animation.get());
+            }
+        }
+        for (Animation *animation : running) {
+            animator->finish(animation);
+        }
+        return G_SOURCE_REMOVE;
+    }, this);
+    wait();
+}
+
+AnimationStats NotificationAnimator::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    AnimationStats stats = m_stats;
+    stats.running = m_running.size();
+    return stats;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <glib.h>
+#include <libnotify/notify.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "resourceids.h"
+
+// animated toast images. QImage only ever gives us the first frame of a gif,
+// so h.gif just sat there. with animation on, every frame gets decoded once
+// into ready to send image-data variants, and a toast with an animated image
+// keeps getting re-shown under the same server id with the next frame.
+// re-showing is a d-bus round trip per frame, so the animator keeps to a cpu
+// budget and skips frames instead of falling behind or eating a core
+
+struct AnimationFrames {
+    std::vector<GVariant *> frames; // (iiibii@ay), same layout as ImageCache
+    std::vector<int> delays;        // ms each frame stays up
+    int loopCount = 0;              // 0 loops forever (well, for maxDuration)
+    int totalDelay = 0;             // one loop, in ms
+    std::size_t bytes = 0;
+
+    AnimationFrames() = default;
+    ~AnimationFrames();
+    AnimationFrames(const AnimationFrames &) = delete;
+    AnimationFrames &operator=(const AnimationFrames &) = delete;
+};
+
+// decoded frames of id, nullptr if its not animated (or not there).
+// decoded once and kept, scaled like ImageCache::maxDimension()
+std::shared_ptr<const AnimationFrames> animationFrames(ResourceId id);
+
+struct AnimationStats {
+    std::uint64_t started = 0;
+    std::uint64_t framesShown = 0;
+    std::uint64_t framesDropped = 0; // skipped to stay on time or in budget
+    std::size_t running = 0;
+    double cpuMs = 0;                // spent re-showing frames
+};
+
+class NotificationAnimator {
+public:
+    static NotificationAnimator &instance();
+
+    // takes its own ref on n, which should already be showing with frame 0.
+    // false if too many animations are already running
+    bool animate(NotifyNotification *n, std::shared_ptr<const AnimationFrames> frames);
+
+    // fraction of one core the animations may use between them (default 0.05)
+    void setCpuBudget(double fraction);
+    // animations stop after this long even if the gif loops forever
+    void setMaxDuration(std::chrono::milliseconds duration);
+
+    // blocks until nothing is animating anymore
+    void wait();
+    void stopAll();
+
+    AnimationStats stats() const;
+
+    static constexpr std::size_t maxRunning = 4;
+
+private:
+    struct Animation;
+
+    NotificationAnimator();
+    ~NotificationAnimator();
+    NotificationAnimator(const NotificationAnimator &) = delete;
+    NotificationAnimator &operator=(const NotificationAnimator &) = delete;
+
+    void run();
+    void schedule(Animation *animation, std::chrono::milliseconds delay);
+    static gboolean tick(gpointer animation);
+    static gboolean quit(gpointer loop);
+    static void closed(NotifyNotification *n, gpointer animation);
+    void finish(Animation *animation);
+
+    GMainContext *m_context;
+    GMainLoop *m_loop;
+    std::thread m_thread;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_idle;
+    std::list<std::unique_ptr<Animation>> m_running;
+    double m_cpuBudget = 0.05;
+    std::chrono::milliseconds m_maxDuration{30000};
+    AnimationStats m_stats;
+};
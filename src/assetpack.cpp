@@ -0,0 +1,128 @@
+#include "assetpack.h"
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+AssetPack &AssetPack::instance() {
+    static AssetPack pack;
+    return pack;
+}
+
+std::string AssetPack::defaultPath() {
+    std::error_code error;
+    std::filesystem::path exe = std::filesystem::read_symlink("/proc/self/exe", error);
+    if (error) {
+        return "thenews.pack";
+    }
+    return (exe.parent_path() / "thenews.pack").string();
+}
+
+static bool fail(std::string *error, const std::string &message) {
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+bool AssetPack::open(const std::string &path, std::string *error) {
+    if (m_data) {
+        return fail(error, "an asset pack is already open");
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return fail(error, "cant open " + path + ": " + std::strerror(errno));
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(AssetPackHeader)) {
+        ::close(fd);
+        return fail(error, path + " is too small to be an asset pack");
+    }
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return fail(error, "cant map " + path + ": " + std::strerror(errno));
+    }
+
+    auto *data = static_cast<const unsigned char *>(mapped);
+    auto *header = reinterpret_cast<const AssetPackHeader *>(data);
+    std::size_t tableEnd = sizeof(AssetPackHeader) + static_cast<std::size_t>(header->count) * sizeof(AssetPackEntry);
+    if (std::memcmp(header->magic, assetPackMagic, sizeof(assetPackMagic)) != 0 || header->version != assetPackVersion || tableEnd > size) {
+        munmap(mapped, size);
+        return fail(error, path + " isnt an asset pack this build can read, rebuild it");
+    }
+
+    auto *entries = reinterpret_cast<const AssetPackEntry *>(data + sizeof(AssetPackHeader));
+    for (std::uint32_t i = 0; i < header->count; i++) {
+        const AssetPackEntry &entry = entries[i];
+        if (entry.offset > size || entry.size > size - entry.offset || entry.name[sizeof(entry.name) - 1] != '\0') {
+            m_entries.clear();
+            munmap(mapped, size);
+            return fail(error, path + " is damaged, rebuild it");
+        }
+        m_entries.emplace(std::string_view(entry.name), &entry);
+    }
+
+    // the whole thing gets read on the first few toasts anyway
+    madvise(mapped, size, MADV_WILLNEED);
+
+    m_data = data;
+    m_size = size;
+    m_header = header;
+    return true;
+}
+
+bool AssetPack::isOpen() const {
+    return m_data != nullptr;
+}
+
+GVariant *AssetPack::imageData(const char *resourcePath, int maxDimension, bool packRgb, ImageSize &dimensions) const {
+    if (!m_data || m_header->maxDimension != maxDimension || ((m_header->flags & assetPackOpaqueAsRgb) != 0) != packRgb) {
+        return nullptr;
+    }
+    auto it = m_entries.find(resourcePath);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+    const AssetPackEntry &entry = *it->second;
+
+    dimensions.width = entry.width;
+    dimensions.height = entry.height;
+    dimensions.channels = entry.channels;
+    dimensions.bytes = entry.size;
+    dimensions.originalWidth = entry.originalWidth;
+    dimensions.originalHeight = entry.originalHeight;
+    dimensions.originalBytes = static_cast<std::size_t>(entry.originalWidth) * entry.originalHeight * 4;
+
+    // static because the mapping never goes away, glib doesnt copy or free it
+    GBytes *bytes = g_bytes_new_static(m_data + entry.offset, entry.size);
+    GVariant *imageData = g_variant_new("(iiibii@ay)",
+        entry.width, entry.height, entry.rowstride, entry.hasAlpha ? TRUE : FALSE, entry.bitsPerSample, entry.channels,
+        g_variant_new_from_bytes(G_VARIANT_TYPE_BYTESTRING, bytes, TRUE)
+    );
+    g_bytes_unref(bytes);
+    return g_variant_ref_sink(imageData);
+}
+
+std::size_t AssetPack::entries() const {
+    return m_entries.size();
+}
+
+std::size_t AssetPack::mappedBytes() const {
+    return m_size;
+}
+
+int AssetPack::maxDimension() const {
+    return m_header ? m_header->maxDimension : 0;
+}
+
+bool AssetPack::opaqueAsRgb() const {
+    return m_header && (m_header->flags & assetPackOpaqueAsRgb) != 0;
+}
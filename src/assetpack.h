@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "imagecache.h"
+
+// thenews.pack: the notification images already scaled and converted to
+// what the image-data hint wants, written at build time by thenews_pack
+// (tools/pack_assets.cpp). at runtime the file gets mmapped and the hint
+// points straight at the mapped pixels, so there is no decode, no convert
+// and no copy, not even on the first toast.
+//
+// layout: AssetPackHeader, count AssetPackEntry, then the pixels of each
+// entry at its offset (64 byte aligned). native byte order, its built on the
+// machine that runs it
+
+constexpr char assetPackMagic[8] = {'N', 'E', 'W', 'S', 'P', 'A', 'K', '\0'};
+constexpr std::uint32_t assetPackVersion = 1;
+constexpr std::uint32_t assetPackOpaqueAsRgb = 1; // flags: opaque images are 3 channel
+
+struct AssetPackHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t count;
+    std::int32_t maxDimension; // what the images were scaled to, 0 for full size
+    std::uint32_t flags;
+};
+
+struct AssetPackEntry {
+    char name[48];             // qrc path, ":/assets/astolfo.jpg"
+    std::int32_t width;
+    std::int32_t height;
+    std::int32_t rowstride;
+    std::int32_t originalWidth;
+    std::int32_t originalHeight;
+    std::uint8_t hasAlpha;
+    std::uint8_t channels;
+    std::uint8_t bitsPerSample;
+    std::uint8_t reserved;
+    std::uint64_t offset;      // from the start of the file
+    std::uint64_t size;
+};
+
+static_assert(sizeof(AssetPackHeader) == 24, "the pack header is part of the file format");
+static_assert(sizeof(AssetPackEntry) == 88, "pack entries are part of the file format");
+
+class AssetPack {
+public:
+    static AssetPack &instance();
+
+    // thenews.pack next to the executable
+    static std::string defaultPath();
+
+    // maps the pack, call it before anything gets sent. false (with error
+    // filled in) if its missing or not a pack this build understands
+    bool open(const std::string &path, std::string *error = nullptr);
+    bool isOpen() const;
+
+    // zero copy image-data for resourcePath, nullptr if the pack doesnt have
+    // it or was built for another maxDimension / rgb packing. you get your
+    // own ref, the pixels stay mapped until the process exits
+    GVariant *imageData(const char *resourcePath, int maxDimension, bool packRgb, ImageSize &dimensions) const;
+
+    std::size_t entries() const;
+    std::size_t mappedBytes() const;
+    // what the pack was built with, 0 and false if none is open
+    int maxDimension() const;
+    bool opaqueAsRgb() const;
+
+private:
+    AssetPack() = default;
+    // never unmaps, variants handed out point into the mapping
+    ~AssetPack() = default;
+    AssetPack(const AssetPack &) = delete;
+    AssetPack &operator=(const AssetPack &) = delete;
+
+    const unsigned char *m_data = nullptr;
+    std::size_t m_size = 0;
+    const AssetPackHeader *m_header = nullptr;
+    std::unordered_map<std::string_view, const AssetPackEntry *> m_entries;
+};
@@ -0,0 +1,245 @@
+#include "autotoast.h"
+
+#include <algorithm>
+
+#include "dispatcher.h"
+#include "percentile.h"
+
+namespace {
+
+constexpr std::size_t latencyWindow = 1024;
+
+// the classic rotation shows up 4 times as often as the rest by default
+constexpr std::array<unsigned, notificationCount> defaultWeights() {
+    std::array<unsigned, notificationCount> weights{};
+    for (auto &weight : weights) {
+        weight = 1;
+    }
+    for (NotificationId id : autoToastRotation) {
+        weights[static_cast<std::size_t>(id)] = 4;
+    }
+    return weights;
+}
+
+} // namespace
+
+bool parseAutoToastPlaylist(std::string_view name, AutoToastPlaylist &out) {
+    if (name == "classic") {
+        out = AutoToastPlaylist::Classic;
+    } else if (name == "sequential") {
+        out = AutoToastPlaylist::Sequential;
+    } else if (name == "random") {
+        out = AutoToastPlaylist::Random;
+    } else if (name == "weighted") {
+        out = AutoToastPlaylist::Weighted;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *autoToastPlaylistName(AutoToastPlaylist playlist) {
+    switch (playlist) {
+        case AutoToastPlaylist::Sequential: return "sequential";
+        case AutoToastPlaylist::Random: return "random";
+        case AutoToastPlaylist::Weighted: return "weighted";
+        default: return "classic";
+    }
+}
+
+AutoToastScheduler::AutoToastScheduler(NotificationDispatcher &dispatcher)
+    : m_dispatcher(dispatcher),
+      m_weights(defaultWeights()),
+      m_random(std::random_device{}()),
+      m_lastStats(Clock::now()) {
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&m_timer, &QTimer::timeout, [this]() {
+        tick();
+    });
+    m_latencies.reserve(latencyWindow);
+    rebuildPlaylist();
+}
+
+void AutoToastScheduler::start() {
+    m_running = true;
+    m_position = 0;
+    m_next = Clock::now();
+    m_lastRefill = m_next;
+    m_tokens = 1;
+    arm();
+}
+
+void AutoToastScheduler::stop() {
+    m_running = false;
+    m_timer.stop();
+}
+
+bool AutoToastScheduler::isRunning() const {
+    return m_running;
+}
+
+void AutoToastScheduler::setInterval(std::chrono::milliseconds interval) {
+    m_interval = std::max(interval, std::chrono::milliseconds(0));
+    if (m_running) {
+        // start counting from now, otherwise a longer interval would think
+        // it has a bunch of missed ticks to catch up on
+        m_next = Clock::now() + m_interval;
+        arm();
+    }
+}
+
+void AutoToastScheduler::setRateLimit(double toastsPerSecond) {
+    m_rateLimit = std::max(toastsPerSecond, 0.0);
+    m_tokens = std::min(m_tokens, 1.0);
+}
+
+void AutoToastScheduler::setPlaylist(AutoToastPlaylist playlist) {
+    m_playlist = playlist;
+    m_position = 0;
+    rebuildPlaylist();
+}
+
+void AutoToastScheduler::setWeights(const std::array<unsigned, notificationCount> &weights) {
+    m_weights = weights;
+    rebuildPlaylist();
+}
+
+void AutoToastScheduler::rebuildPlaylist() {
+    m_candidates.clear();
+    std::vector<double> weights;
+
+    if (m_playlist == AutoToastPlaylist::Classic) {
+        m_candidates.assign(autoToastRotation.begin(), autoToastRotation.end());
+    } else {
+        for (const auto &desc : notificationCatalog) {
+            // the h one writes a desktop file every time, not doing that on a loop
+            if (desc.deploysH) {
+                continue;
+            }
+            if (m_playlist == AutoToastPlaylist::Weighted && m_weights[static_cast<std::size_t>(desc.id)] == 0) {
+                continue;
+            }
+            m_candidates.push_back(desc.id);
+            weights.push_back(m_weights[static_cast<std::size_t>(desc.id)]);
+        }
+    }
+
+    m_weighted = std::discrete_distribution<std::size_t>(weights.begin(), weights.end());
+}
+
+NotificationId AutoToastScheduler::nextNotification() {
+    if (m_candidates.empty()) {
+        return NotificationId::Count;
+    }
+    switch (m_playlist) {
+        case AutoToastPlaylist::Random:
+            return m_candidates[std::uniform_int_distribution<std::size_t>(0, m_candidates.size() - 1)(m_random)];
+        case AutoToastPlaylist::Weighted:
+            return m_candidates[m_weighted(m_random)];
+        default: {
+            NotificationId id = m_candidates[m_position];
+            m_position = (m_position + 1) % m_candidates.size();
+            return id;
+        }
+    }
+}
+
+bool AutoToastScheduler::takeToken(Clock::time_point now) {
+    if (m_rateLimit <= 0) {
+        return true;
+    }
+    double elapsed = std::chrono::duration<double>(now - m_lastRefill).count();
+    m_lastRefill = now;
+    // a tenth of a second worth of burst, at least one toast
+    double burst = std::max(1.0, m_rateLimit / 10.0);
+    m_tokens = std::min(burst, m_tokens + elapsed * m_rateLimit);
+    if (m_tokens < 1.0) {
+        return false;
+    }
+    m_tokens -= 1.0;
+    return true;
+}
+
+void AutoToastScheduler::tick() {
+    if (!m_running) {
+        return;
+    }
+    Clock::time_point now = Clock::now();
+    m_ticks++;
+
+    if (m_interval.count() > 0) {
+        // were we so late that whole ticks went by? send once for all of them
+        auto behind = now - m_next;
+        if (behind >= m_interval) {
+            auto missed = behind / m_interval;
+            m_missedTicks += static_cast<std::uint64_t>(missed);
+            m_next += missed * m_interval;
+        }
+    }
+
+    bool allowed = takeToken(now);
+    if (allowed) {
+        NotificationId id = nextNotification();
+        if (id != NotificationId::Count) {
+            m_dispatcher.enqueue(id);
+        }
+    } else {
+        m_limitedTicks++;
+    }
+
+    if (m_interval.count() > 0) {
+        // off the schedule, not off now, so it doesnt drift
+        m_next += m_interval;
+    } else if (!allowed && m_rateLimit > 0) {
+        // flat out but out of tokens, sleep until the next one
+        auto wait = std::chrono::duration<double>((1.0 - m_tokens) / m_rateLimit);
+        m_next = now + std::chrono::duration_cast<Clock::duration>(wait);
+    } else {
+        m_next = now;
+    }
+    arm();
+}
+
+void AutoToastScheduler::arm() {
+    if (!m_running) {
+        return;
+    }
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(m_next - Clock::now());
+    m_timer.start(static_cast<int>(std::max<std::chrono::milliseconds::rep>(0, delay.count())));
+}
+
+void AutoToastScheduler::recordResult(const DispatchResult &result) {
+    if (result.ok) {
+        m_sent++;
+    } else {
+        m_failed++;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(result.waited + result.sent).count();
+    if (m_latencies.size() < latencyWindow) {
+        m_latencies.push_back(ms);
+    } else {
+        m_latencies[m_latencyNext] = ms;
+    }
+    m_latencyNext = (m_latencyNext + 1) % latencyWindow;
+}
+
+AutoToastStats AutoToastScheduler::stats() {
+    Clock::time_point now = Clock::now();
+    double elapsed = std::chrono::duration<double>(now - m_lastStats).count();
+
+    AutoToastStats stats;
+    stats.achievedRate = elapsed > 0 ? (m_sent - m_sentAtLastStats) / elapsed : 0;
+    stats.p50LatencyMs = percentile(m_latencies, 0.5);
+    stats.p99LatencyMs = percentile(m_latencies, 0.99);
+    stats.ticks = m_ticks;
+    stats.sent = m_sent;
+    stats.failed = m_failed;
+    stats.missedTicks = m_missedTicks;
+    stats.limitedTicks = m_limitedTicks;
+
+    m_lastStats = now;
+    m_sentAtLastStats = m_sent;
+    return stats;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include <QTimer>
+
+#include "catalog.h"
+
+class NotificationDispatcher;
+struct DispatchResult;
+
+// drives the auto toast. ticks are scheduled against fixed deadlines
+// (start + n * interval) so they dont drift, ticks that were missed because
+// the event loop was busy get coalesced into one instead of firing in a
+// burst, and a token bucket caps the toasts per second no matter what the
+// slider says. sends go through the dispatcher so a tick never blocks
+
+enum class AutoToastPlaylist : std::uint8_t {
+    Classic,    // the 10 toasts the auto toast always did
+    Sequential, // the whole catalog in order
+    Random,     // the whole catalog, uniformly
+    Weighted    // the whole catalog, following setWeights()
+};
+
+bool parseAutoToastPlaylist(std::string_view name, AutoToastPlaylist &out);
+const char *autoToastPlaylistName(AutoToastPlaylist playlist);
+
+struct AutoToastStats {
+    double achievedRate = 0;  // toasts/s that actually got sent since the last stats() call
+    double p50LatencyMs = 0;  // queued -> shown
+    double p99LatencyMs = 0;
+    std::uint64_t ticks = 0;
+    std::uint64_t sent = 0;
+    std::uint64_t failed = 0;
+    std::uint64_t missedTicks = 0;  // coalesced because we were late
+    std::uint64_t limitedTicks = 0; // skipped by the rate limit
+};
+
+class AutoToastScheduler {
+public:
+    explicit AutoToastScheduler(NotificationDispatcher &dispatcher);
+
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    void setInterval(std::chrono::milliseconds interval);
+    // toasts per second, 0 means no limit
+    void setRateLimit(double toastsPerSecond);
+    void setPlaylist(AutoToastPlaylist playlist);
+    // for AutoToastPlaylist::Weighted, 0 takes a toast out of the rotation
+    void setWeights(const std::array<unsigned, notificationCount> &weights);
+
+    // feed this every dispatch result so the latency numbers mean something
+    void recordResult(const DispatchResult &result);
+
+    // computes the achieved rate since the previous call, so call it on a timer
+    AutoToastStats stats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void tick();
+    void arm();
+    bool takeToken(Clock::time_point now);
+    NotificationId nextNotification();
+    void rebuildPlaylist();
+
+    NotificationDispatcher &m_dispatcher;
+    QTimer m_timer;
+    bool m_running = false;
+
+    std::chrono::milliseconds m_interval{100};
+    Clock::time_point m_next;
+
+    double m_rateLimit = 0;
+    double m_tokens = 0;
+    Clock::time_point m_lastRefill;
+
+    AutoToastPlaylist m_playlist = AutoToastPlaylist::Classic;
+    std::array<unsigned, notificationCount> m_weights;
+    std::vector<NotificationId> m_candidates;
+    std::discrete_distribution<std::size_t> m_weighted;
+    std::mt19937 m_random;
+    std::size_t m_position = 0;
+
+    std::vector<double> m_latencies; // ring buffer of the last latencyWindow sends, in ms
+    std::size_t m_latencyNext = 0;
+
+    std::uint64_t m_ticks = 0;
+    std::uint64_t m_sent = 0;
+    std::uint64_t m_failed = 0;
+    std::uint64_t m_missedTicks = 0;
+    std::uint64_t m_limitedTicks = 0;
+    std::uint64_t m_sentAtLastStats = 0;
+    Clock::time_point m_lastStats;
+};
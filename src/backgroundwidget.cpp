@@ -0,0 +1,73 @@
+#include "backgroundwidget.h"
+
+#include <QPaintEvent>
+#include <QPainter>
+#include <QRectF>
+#include <QResizeEvent>
+
+// how long the size has to stay put before it counts as done resizing
+static constexpr int settleMs = 150;
+
+BackgroundWidget::BackgroundWidget(QWidget *parent) : QWidget(parent) {
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(settleMs);
+    QObject::connect(&m_settleTimer, &QTimer::timeout, this, [this]() {
+        settled();
+    });
+}
+
+void BackgroundWidget::setImage(const QString &path) {
+    m_path = path;
+    m_source = QPixmap();
+    m_scaled = QPixmap();
+    setAttribute(Qt::WA_OpaquePaintEvent, false);
+    update();
+}
+
+void BackgroundWidget::rescale(qreal dpr, Qt::TransformationMode mode) {
+    if (m_source.isNull() && !m_path.isEmpty()) {
+        m_source = QPixmap(m_path);
+        // nothing below shows through, so qt can skip painting it
+        setAttribute(Qt::WA_OpaquePaintEvent, !m_source.isNull() && !m_source.hasAlphaChannel());
+    }
+    if (m_source.isNull()) {
+        return;
+    }
+
+    QSize target(qRound(width() * dpr), qRound(height() * dpr));
+    m_scaled = m_source.size() == target ? m_source : m_source.scaled(target, Qt::IgnoreAspectRatio, mode);
+    m_scaled.setDevicePixelRatio(dpr);
+    m_scaledMode = mode;
+}
+
+void BackgroundWidget::paintEvent(QPaintEvent *event) {
+    qreal dpr = devicePixelRatioF();
+    QSize target(qRound(width() * dpr), qRound(height() * dpr));
+    if (m_scaled.isNull() || m_scaled.size() != target || m_scaled.devicePixelRatio() != dpr) {
+        rescale(dpr, m_settleTimer.isActive() ? Qt::FastTransformation : Qt::SmoothTransformation);
+    }
+    if (m_scaled.isNull()) {
+        return;
+    }
+
+    // same pixels as the pixmap, no scaling left to do here
+    QRect area = event->rect();
+    QPainter painter(this);
+    painter.drawPixmap(area.topLeft(), m_scaled,
+                       QRectF(area.x() * dpr, area.y() * dpr, area.width() * dpr, area.height() * dpr));
+}
+
+void BackgroundWidget::resizeEvent(QResizeEvent *event) {
+    QWidget::resizeEvent(event);
+    // the first size isnt a live resize, thats just getting laid out
+    if (!m_scaled.isNull()) {
+        m_settleTimer.start();
+    }
+}
+
+void BackgroundWidget::settled() {
+    if (m_scaledMode == Qt::FastTransformation && !m_scaled.isNull()) {
+        rescale(m_scaled.devicePixelRatio(), Qt::SmoothTransformation);
+        update();
+    }
+}
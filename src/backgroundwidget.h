@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QPixmap>
+#include <QString>
+#include <QTimer>
+#include <QWidget>
+
+// an image stretched over the whole widget, what the page labels did with
+// "border-image: url(...) 0 0 0 0 stretch stretch". the stylesheet scales the
+// full size image again on every paint, including every time a button on top
+// of it gets hovered. this scales it once per size and dpr and paints by
+// copying the part that needs repainting out of that. while the size keeps
+// changing (a live resize) the scaling is the fast kind, once it settles it
+// gets done once more smoothly. the image is only decoded at the first paint,
+// and opaque ones tell qt not to bother painting whatever is underneath
+
+class BackgroundWidget : public QWidget {
+public:
+    explicit BackgroundWidget(QWidget *parent = nullptr);
+
+    void setImage(const QString &path);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void rescale(qreal dpr, Qt::TransformationMode mode);
+    void settled();
+
+    QString m_path;
+    QPixmap m_source;
+    QPixmap m_scaled;
+    Qt::TransformationMode m_scaledMode = Qt::FastTransformation;
+    QTimer m_settleTimer;
+};
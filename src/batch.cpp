@@ -0,0 +1,99 @@
+#include "batch.h"
+
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <thread>
+
+#include "notifications.h"
+
+namespace {
+
+// one id per line, with or without the --. blank lines and # comments are skipped
+bool readList(std::istream &in, const std::string &name, std::vector<NotificationId> &out, std::size_t &unknown) {
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+
+        std::string_view key = line;
+        while (!key.empty() && (key.front() == ' ' || key.front() == '\t')) {
+            key.remove_prefix(1);
+        }
+        while (!key.empty() && (key.back() == ' ' || key.back() == '\t' || key.back() == '\r')) {
+            key.remove_suffix(1);
+        }
+        if (key.empty() || key.front() == '#') {
+            continue;
+        }
+        if (key.substr(0, 2) == "--") {
+            key.remove_prefix(2);
+        }
+
+        NotificationId id;
+        if (findNotification(key, id)) {
+            out.push_back(id);
+        } else {
+            std::cerr << name << ":" << lineNumber << ": no notification called " << key << "\n";
+            unknown++;
+        }
+    }
+    return !in.bad();
+}
+
+} // namespace
+
+bool runBatch(const BatchOptions &options, BatchSummary &summary) {
+    std::vector<NotificationId> notifications = options.notifications;
+    std::size_t unknown = 0;
+
+    for (const auto &list : options.lists) {
+        if (list == "-") {
+            if (!readList(std::cin, "stdin", notifications, unknown)) {
+                std::cerr << "couldnt read the list from stdin\n";
+                return false;
+            }
+            continue;
+        }
+        std::ifstream file(list);
+        if (!file || !readList(file, list, notifications, unknown)) {
+            std::cerr << "couldnt read the list " << list << "\n";
+            return false;
+        }
+    }
+
+    summary = BatchSummary();
+    summary.failed = unknown * options.repeat;
+
+    auto start = std::chrono::steady_clock::now();
+    auto next = start;
+    bool first = true;
+
+    for (std::size_t round = 0; round < options.repeat; round++) {
+        for (NotificationId id : notifications) {
+            if (!first && options.interval.count() > 0) {
+                // sleeping until the next slot instead of for the interval so slow sends dont add up
+                next += options.interval;
+                std::this_thread::sleep_until(next);
+            }
+            first = false;
+
+            if (sendNotification(id)) {
+                summary.sent++;
+            } else {
+                summary.failed++;
+            }
+        }
+    }
+
+    summary.elapsed = std::chrono::steady_clock::now() - start;
+
+    double seconds = std::chrono::duration<double>(summary.elapsed).count();
+    std::cout << "batch: " << summary.sent << " sent, " << summary.failed << " failed in "
+              << seconds * 1000.0 << " ms";
+    if (seconds > 0) {
+        std::cout << " (" << summary.sent / seconds << " toasts/s)";
+    }
+    std::cout << "\n";
+    return true;
+}
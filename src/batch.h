@@ -0,0 +1,29 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "catalog.h"
+
+// sending a pile of notifications from one process, so scripting a thousand
+// toasts doesnt mean a thousand startups and a thousand d-bus connections.
+// everything goes through the same libnotify session and image cache
+
+struct BatchOptions {
+    std::vector<NotificationId> notifications; // from the --xyz flags, in order
+    std::vector<std::string> lists;            // files with one id per line, "-" is stdin
+    std::size_t repeat = 1;
+    std::chrono::milliseconds interval{0};
+};
+
+struct BatchSummary {
+    std::size_t sent = 0;
+    std::size_t failed = 0;
+    std::chrono::steady_clock::duration elapsed{};
+};
+
+// reads the lists, sends everything repeat times and prints a summary.
+// returns false if a list couldnt be read
+bool runBatch(const BatchOptions &options, BatchSummary &summary);
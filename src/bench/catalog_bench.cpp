@@ -0,0 +1,158 @@
+// how long does it take to go from a notification name to its title/body?
+// "legacy" is the old if/else chain from sendNotification(), "catalog" is
+// findNotification() + notificationDescriptor(), "enum" is what the gui and
+// the auto toast do now (no string at all)
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../catalog.h"
+
+namespace {
+
+// copy of the old chain minus the libnotify calls, it built the title and
+// message strings for every toast
+std::size_t legacyDispatch(const std::string &notificationType) {
+    std::string title;
+    std::string message;
+
+    if (notificationType == "someoneDied") {
+        title = "BREAKING NEWS!!!";
+        message = "Someone just died! Who? We don't know.";
+    } else if (notificationType == "donate") {
+        title = "we need your money";
+        message = "donate to \"the news\"\n\n";
+    } else if (notificationType == "serversDying") {
+        title = "please donate us money";
+        message = "our in house servers ae dying of money :(\n\n";
+    } else if (notificationType == "deleteSystem32") {
+        title = "welp";
+        message = "since you didn't donate to the news...\ndeleting system32...\n21/15,245 files";
+    } else if (notificationType == "incomingCall") {
+        title = "John Phone";
+        message = "Incoming Call - Satellite";
+    } else if (notificationType == "earthOnFire") {
+        title = "BREAKING NEWS! the earth is on fire lmfao";
+        message = "weather forecast:\n\n"
+                  "Mon: ☀️ 63° / 42°\n"
+                  "Tue: ☀️ 78° / 60°\n"
+                  "Wed: ☀️ 96° / 76°\n"
+                  "Thu: ☀️ 132° / 89°\n"
+                  "Fri: ☀️ 244° / 120°";
+    } else if (notificationType == "friendRequest") {
+        title = "John Phone sent you a friend request";
+        message = "i want Sponsorships.";
+    } else if (notificationType == "websiteRedesign") {
+        title = "we redesigned our website";
+        message = "enjoy it and leave feed back";
+    } else if (notificationType == "roadblocks") {
+        title = "BREAKING NEWS!!!";
+        message = "California man posts TikTok of him riding in his golf cart rambling on about 'roadblocks' on the beach, goes crazy fucking viral.";
+    } else if (notificationType == "linkerTragedy") {
+        title = "BREAKING NEWS!!!";
+        message = "Discord user @linker.sh, from the server 'Face's attic', goes all in on black, loses it all in 1 night - tragedy unfolds.";
+    } else if (notificationType == "mazeGambled") {
+        title = "BREAKING NEWS!!!!!!!!!!!!!!!!!!!!!";
+        message = "MAZE CONCENTRATED ON GAMBLING SO HARD THEY GOT $-1 IN RETURN???";
+    } else if (notificationType == "femboyLabs") {
+        title = "BREAKING NEWS!!!";
+        message = "femboyLabs has rebranded again!";
+    } else if (notificationType == "bussinIndustries") {
+        title = "BREAKING NEWS!!!";
+        message = "Bussin Industries shares cryptic note on staff channels.\n\nSource: X";
+    } else if (notificationType == "hTile") {
+        title = "h";
+        message = "check your start menu and enjoy your free h";
+    } else if (notificationType == "baseballEmoji") {
+        title = "⚾️ Baseball on Discord?! 🤯";
+        message = "Fr fr, a baseball emoji just dropped on Discord. Icl, ts kinda mogging ngl. 🤣";
+    } else if (notificationType == "jonathanPork") {
+        title = "John Pork";
+        message = "Incoming Call - Satellite";
+    } else if (notificationType == "linkerAgain") {
+        title = "Text message from +1 248-434-5508";
+        message = "We've successfully assassinated the attacker. Thank you for contacting Valve Support.\n\nLinker's Samsung Galaxy";
+    } else if (notificationType == "hGif") {
+        title = "h";
+        message = "h";
+    } else if (notificationType == "findMeOnline") {
+        title = "John Phone";
+        message = "Find me online";
+    } else if (notificationType == "googServices") {
+        title = "the news needs Google Play Services";
+        message = "the news uses Google Play Services to provide you a better experience. Install it. Right now. I don't care that you are using a desktop OS. Install it.";
+    } else if (notificationType == "flash") {
+        title = "BREAKING NEWS!!!";
+        message = "To view this notification, install Adobe® Flash Player™";
+    } else if (notificationType == "mcafee") {
+        title = "BREAKING NEWS!!!";
+        message = "Your McAfee™ subscription plan has expired. Please select a new one below.\n\nEssential - $119.99\nMcAfee+™ Premium Individual - $149.99\nMcAfee+™ Advanced Individual - $199.99";
+    } else if (notificationType == "noskid") {
+        title = "BREAKING NEWS!!!";
+        message = "To view this notification, upload a NoSkid certificate.";
+    } else {
+        title = "no notification :(";
+        message = "notification doesnt exist somehow what did i call to get this...?";
+    }
+
+    return title.size() + message.size();
+}
+
+std::size_t catalogDispatch(const std::string &notificationType) {
+    NotificationId id;
+    const NotificationDescriptor &desc = findNotification(notificationType, id)
+        ? notificationDescriptor(id)
+        : unknownNotification;
+    return std::strlen(desc.title) + std::strlen(desc.body);
+}
+
+std::size_t enumDispatch(NotificationId id) {
+    const NotificationDescriptor &desc = notificationDescriptor(id);
+    return std::strlen(desc.title) + std::strlen(desc.body);
+}
+
+template <typename Fn>
+double nsPerCall(std::size_t iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; i++) {
+        fn(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::size_t iterations = 2000000;
+    if (argc > 1) {
+        iterations = std::stoul(argv[1]);
+    }
+
+    std::vector<std::string> names;
+    for (const auto &desc : notificationCatalog) {
+        names.emplace_back(desc.key);
+    }
+
+    volatile std::size_t sink = 0;
+
+    double legacy = nsPerCall(iterations, [&](std::size_t i) {
+        sink = sink + legacyDispatch(names[i % names.size()]);
+    });
+    double catalog = nsPerCall(iterations, [&](std::size_t i) {
+        sink = sink + catalogDispatch(names[i % names.size()]);
+    });
+    double byEnum = nsPerCall(iterations, [&](std::size_t i) {
+        sink = sink + enumDispatch(static_cast<NotificationId>(i % notificationCount));
+    });
+
+    std::cout << "catalog dispatch, " << iterations << " lookups over " << names.size() << " notifications\n";
+    std::cout << "  legacy if/else chain: " << legacy << " ns/dispatch\n";
+    std::cout << "  catalog by name:      " << catalog << " ns/dispatch\n";
+    std::cout << "  catalog by enum:      " << byEnum << " ns/dispatch\n";
+    return 0;
+}
@@ -0,0 +1,79 @@
+// how long does a script wait for a toast? "spawn" runs thenews --<id> for
+// every toast like our cron jobs do, "daemon" asks an already running
+// thenews --daemon over the control socket like thenews --send does.
+// start the daemon first: thenews --daemon &
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <spawn.h>
+#include <sys/wait.h>
+
+#include "../control.h"
+#include "../percentile.h"
+
+extern char **environ;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void report(const char *name, const std::vector<double> &micros, std::size_t failed) {
+    std::cout << "  " << name << ": p50 " << percentile(micros, 0.5) << " us, p99 " << percentile(micros, 0.99)
+              << " us, max " << percentile(micros, 1.0) << " us";
+    if (failed) {
+        std::cout << " (" << failed << " failed)";
+    }
+    std::cout << "\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: thenews_daemon_bench /path/to/thenews [toasts] [id]\n";
+        return 1;
+    }
+    std::string binary = argv[1];
+    std::size_t toasts = argc > 2 ? std::stoul(argv[2]) : 100;
+    std::string id = argc > 3 ? argv[3] : "someoneDied";
+    std::string socketPath = defaultControlSocketPath();
+
+    std::cout << "latency per toast, " << toasts << " x " << id << "\n";
+
+    std::vector<double> spawn;
+    std::size_t spawnFailed = 0;
+    std::string flag = "--" + id;
+    for (std::size_t i = 0; i < toasts; i++) {
+        char *args[] = {binary.data(), flag.data(), nullptr};
+        auto start = Clock::now();
+        pid_t pid;
+        int status = 0;
+        if (posix_spawn(&pid, binary.c_str(), nullptr, nullptr, args, environ) != 0 ||
+            waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            spawnFailed++;
+        }
+        spawn.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    report("spawn ", spawn, spawnFailed);
+
+    std::vector<double> daemon;
+    std::size_t daemonFailed = 0;
+    std::vector<std::string> ids = {id};
+    for (std::size_t i = 0; i < toasts; i++) {
+        std::string error;
+        auto start = Clock::now();
+        if (!sendToDaemon(socketPath, ids, error)) {
+            if (daemonFailed++ == 0) {
+                std::cerr << error << "\n";
+            }
+        }
+        daemon.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    report("daemon", daemon, daemonFailed);
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+// does the ui keep painting while we toast as fast as the slider allows (0ms)?
+// a 16ms "frame" timer repaints a window and records the gap between frames
+// while a 0ms timer fires toasts, first with nothing going on, then calling
+// sendNotification() right on the gui thread like the old code, then through
+// NotificationDispatcher. needs a notification daemon on the session bus,
+// run it under QT_QPA_PLATFORM=offscreen if theres no display
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../catalog.h"
+#include "../dispatcher.h"
+#include "../notifications.h"
+#include "../percentile.h"
+
+#include <QApplication>
+#include <QEventLoop>
+#include <QTimer>
+#include <QWidget>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Toast>
+void measure(const char *name, QWidget &window, int milliseconds, Toast toast) {
+    std::vector<double> gaps;
+    std::uint64_t toasts = 0;
+    std::size_t rotation = 0;
+
+    QTimer frameTimer;
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    frameTimer.setInterval(16);
+    Clock::time_point lastFrame = Clock::now();
+    QObject::connect(&frameTimer, &QTimer::timeout, [&]() {
+        Clock::time_point now = Clock::now();
+        gaps.push_back(std::chrono::duration<double, std::milli>(now - lastFrame).count());
+        lastFrame = now;
+        window.repaint();
+    });
+
+    QTimer toastTimer;
+    toastTimer.setInterval(0);
+    QObject::connect(&toastTimer, &QTimer::timeout, [&]() {
+        if (toast(autoToastRotation[rotation])) {
+            toasts++;
+        }
+        rotation = (rotation + 1) % autoToastRotation.size();
+    });
+
+    QEventLoop loop;
+    QTimer::singleShot(milliseconds, &loop, &QEventLoop::quit);
+    frameTimer.start();
+    toastTimer.start();
+    loop.exec();
+    toastTimer.stop();
+    frameTimer.stop();
+
+    std::cout << "  " << name << ": " << gaps.size() << " frames, " << toasts << " toasts, frame gap p50 "
+              << percentile(gaps, 0.5) << " ms, p99 " << percentile(gaps, 0.99) << " ms, max "
+              << percentile(gaps, 1.0) << " ms\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    int milliseconds = 3000;
+    if (argc > 1) {
+        milliseconds = std::stoi(argv[1]);
+    }
+
+    QApplication app(argc, argv);
+
+    QWidget window;
+    window.resize(805, 505);
+    window.show();
+
+    std::cout << "ui frame time while toasting every 0ms, " << milliseconds << " ms per run (ideal gap is 16 ms)\n";
+
+    measure("idle         ", window, milliseconds, [](NotificationId) {
+        return false;
+    });
+
+    measure("gui thread   ", window, milliseconds, [](NotificationId id) {
+        return sendNotification(id);
+    });
+
+    {
+        NotificationDispatcher dispatcher(64, DispatchPolicy::DropOldest);
+        measure("dispatcher   ", window, milliseconds, [&dispatcher](NotificationId id) {
+            return dispatcher.enqueue(id);
+        });
+        DispatchStats stats = dispatcher.stats();
+        std::cout << "    dispatcher actually sent " << stats.sent << ", dropped " << stats.dropped
+                  << ", failed " << stats.failed << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+// stress test for NotificationDispatcher itself, where queue_bench only
+// looks at the lanes. a pile of producer threads call enqueue() as fast as
+// they can on a tiny lane (--capacity, default 1) under every policy, while
+// the real dispatch thread sends everything to MockNotificationServer on a
+// private session bus. per policy it checks that:
+//   block     no producer sleeps forever (a lost wakeup hangs the run, the
+//             watchdog fails it after --timeout seconds) and nothing drops
+//   drop      every toast got sent or dropped, none twice
+//   coalesce  every enqueue that returned false was counted as coalesced,
+//             which only the producer taking a type from 0 to 1 gets past
+// and after every run, once its all drained, that one of each type gets
+// through under coalesce, which only works if the waiting counts all went
+// back to 0. exits 1 if anything came out wrong
+//
+//   thenews_dispatcher_stress [--producers N] [--items N] [--capacity N] [--timeout S]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../catalog.h"
+#include "../dispatcher.h"
+#include "mockserver.h"
+
+#include <QCoreApplication>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::size_t producers = 8;
+    std::size_t items = 500; // per producer
+    std::size_t capacity = 1;
+    std::chrono::seconds timeout{60};
+};
+
+// everything but the h, that one writes a desktop file every time
+std::vector<NotificationId> stressTypes() {
+    std::vector<NotificationId> types;
+    for (const auto &desc : notificationCatalog) {
+        if (!desc.deploysH) {
+            types.push_back(desc.id);
+        }
+    }
+    return types;
+}
+
+// a stuck producer cant be joined, so theres nothing to do but leave
+void waitOrDie(const char *policy, const char *what, const Clock::time_point &deadline, const std::function<bool()> &done) {
+    while (!done()) {
+        if (Clock::now() > deadline) {
+            std::printf("  FAILED: %s: %s\n", policy, what);
+            std::fflush(stdout);
+            std::_Exit(1);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool drained(const NotificationDispatcher &dispatcher) {
+    DispatchStats stats = dispatcher.stats();
+    return stats.depth == 0 && stats.sent + stats.failed + stats.dropped == stats.queued;
+}
+
+bool run(DispatchPolicy policy, const Options &options, MockNotificationServer &server) {
+    const char *name = dispatchPolicyName(policy);
+    std::vector<NotificationId> types = stressTypes();
+    server.reset();
+
+    NotificationDispatcher dispatcher(options.capacity, policy);
+    std::atomic<std::uint64_t> accepted{0};
+    std::atomic<std::uint64_t> rejected{0};
+    std::atomic<std::size_t> producersLeft{options.producers};
+    std::atomic<bool> go{false};
+
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < options.producers; p++) {
+        producers.emplace_back([&, p]() {
+            while (!go) {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i < options.items; i++) {
+                if (dispatcher.enqueue(types[(i + p * 7) % types.size()])) {
+                    accepted++;
+                } else {
+                    rejected++;
+                }
+            }
+            producersLeft--;
+        });
+    }
+
+    auto start = Clock::now();
+    Clock::time_point deadline = start + options.timeout;
+    go = true;
+    waitOrDie(name, "a producer never came back from enqueue()", deadline, [&]() {
+        return producersLeft == 0;
+    });
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    waitOrDie(name, "the dispatcher never got through its lanes", deadline, [&]() {
+        return drained(dispatcher);
+    });
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    DispatchStats stats = dispatcher.stats();
+    MockServerStats served = server.stats();
+    std::uint64_t total = options.producers * options.items;
+    std::printf("%-10s %8.0f enqueues/s  %llu accepted, %llu sent, %llu dropped, %llu coalesced, %llu failed, server got %llu\n",
+                name, static_cast<double>(total) / seconds, static_cast<unsigned long long>(accepted.load()),
+                static_cast<unsigned long long>(stats.sent), static_cast<unsigned long long>(stats.dropped),
+                static_cast<unsigned long long>(stats.coalesced), static_cast<unsigned long long>(stats.failed),
+                static_cast<unsigned long long>(served.notifyCalls));
+
+    std::vector<const char *> problems;
+    if (accepted + rejected != total) {
+        problems.push_back("enqueue calls went missing");
+    }
+    if (stats.queued != accepted) {
+        problems.push_back("queued doesnt match what enqueue said it took");
+    }
+    if (stats.coalesced != rejected) {
+        problems.push_back("an enqueue returned false without being coalesced");
+    }
+    if (policy == DispatchPolicy::Block && stats.dropped != 0) {
+        problems.push_back("block dropped toasts");
+    }
+    if (stats.failed != 0 || served.notifyCalls != stats.sent) {
+        problems.push_back("the server didnt get exactly what was sent");
+    }
+
+    // a waiting count that never went back to 0 coalesces its type forever
+    dispatcher.setPolicy(DispatchPolicy::Coalesce);
+    for (NotificationId id : types) {
+        if (!dispatcher.enqueue(id)) {
+            problems.push_back("a type stayed waiting after everything drained");
+            break;
+        }
+        waitOrDie(name, "the dispatcher never sent the last round", deadline, [&]() {
+            return drained(dispatcher);
+        });
+    }
+
+    for (const char *problem : problems) {
+        std::printf("  FAILED: %s\n", problem);
+    }
+    return problems.empty();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--producers" && i + 1 < argc) {
+            options.producers = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--items" && i + 1 < argc) {
+            options.items = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--capacity" && i + 1 < argc) {
+            options.capacity = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--timeout" && i + 1 < argc) {
+            options.timeout = std::chrono::seconds(std::strtoll(argv[++i], nullptr, 10));
+        } else {
+            std::fprintf(stderr, "usage: thenews_dispatcher_stress [--producers N] [--items N] [--capacity N] [--timeout S]\n");
+            return 1;
+        }
+    }
+
+    // has to happen before libnotify or gio look at the session bus
+    PrivateSessionBus bus;
+    if (!bus.start()) {
+        std::fprintf(stderr, "couldnt start dbus-daemon --session, is it installed?\n");
+        return 1;
+    }
+    setenv("DBUS_SESSION_BUS_ADDRESS", bus.address().c_str(), 1);
+    MockNotificationServer server;
+    std::string error;
+    if (!server.start(bus.address(), &error)) {
+        std::fprintf(stderr, "mock notification server: %s\n", error.c_str());
+        return 1;
+    }
+
+    QCoreApplication app(argc, argv);
+
+    std::printf("%zu producers x %zu toasts, %zu per lane\n", options.producers, options.items, options.capacity);
+    bool ok = true;
+    for (DispatchPolicy policy : {DispatchPolicy::Block, DispatchPolicy::DropOldest, DispatchPolicy::Coalesce}) {
+        ok = run(policy, options, server) && ok;
+    }
+    return ok ? 0 : 1;
+}
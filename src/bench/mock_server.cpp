@@ -0,0 +1,107 @@
+// runs MockNotificationServer on its own so thenews itself (the gui, the auto
+// toast, --repeat batches, the daemon) can be load tested without a desktop.
+// with --private-bus it starts its own session bus and prints the address,
+// point thenews at it with DBUS_SESSION_BUS_ADDRESS. ctrl+c prints what it got
+//
+//   thenews_mock_server --private-bus --latency 200 --jitter 50 --fail-rate 0.05
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <glib-unix.h>
+
+#include "mockserver.h"
+
+namespace {
+
+void printReport(const MockNotificationServer &server, bool list) {
+    MockServerStats stats = server.stats();
+    if (list) {
+        for (const auto &n : server.received()) {
+            std::printf("  #%u %s: %s, %zu actions, %zu bytes (%zu image-data)%s%s\n", n.id, n.appName.c_str(), n.summary.c_str(),
+                        n.actions, n.payloadBytes, n.imageDataBytes, n.imagePath ? " +image-path" : "", n.failed ? " FAILED" : "");
+        }
+    }
+    std::printf("notify: %llu calls, %llu failed on purpose, %zu still pending\n",
+                static_cast<unsigned long long>(stats.notifyCalls), static_cast<unsigned long long>(stats.failed), stats.pending);
+    std::printf("payload: %llu bytes total, %zu max, %llu avg\n", static_cast<unsigned long long>(stats.payloadBytes),
+                stats.maxPayloadBytes, static_cast<unsigned long long>(stats.notifyCalls ? stats.payloadBytes / stats.notifyCalls : 0));
+    std::printf("image-data: %llu toasts had one, %llu bytes total, %zu max\n", static_cast<unsigned long long>(stats.withImageData),
+                static_cast<unsigned long long>(stats.imageDataBytes), stats.maxImageDataBytes);
+    std::printf("image-path: %llu toasts had one\n", static_cast<unsigned long long>(stats.withImagePath));
+    std::printf("other: %llu CloseNotification, %llu GetCapabilities, %llu ActionInvoked sent\n",
+                static_cast<unsigned long long>(stats.closeCalls), static_cast<unsigned long long>(stats.capabilityCalls),
+                static_cast<unsigned long long>(stats.actionsInvoked));
+}
+
+gboolean quit(gpointer loop) {
+    g_main_loop_quit(static_cast<GMainLoop *>(loop));
+    return G_SOURCE_REMOVE;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    MockServerConfig config;
+    bool privateBus = false;
+    bool list = false;
+    unsigned reportEvery = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--private-bus") {
+            privateBus = true;
+        } else if (arg == "--latency" && i + 1 < argc) {
+            config.latencyMs = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--jitter" && i + 1 < argc) {
+            config.jitterMs = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--fail-rate" && i + 1 < argc) {
+            config.failureRate = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--invoke-actions") {
+            config.invokeActions = true;
+        } else if (arg == "--list") {
+            list = true;
+        } else if (arg == "--report-every" && i + 1 < argc) {
+            reportEvery = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "usage: thenews_mock_server [--private-bus] [--latency MS] [--jitter MS] [--fail-rate 0..1]\n"
+                         "                           [--invoke-actions] [--list] [--report-every S]\n";
+            return 1;
+        }
+    }
+
+    PrivateSessionBus bus;
+    if (privateBus) {
+        if (!bus.start()) {
+            std::cerr << "couldnt start dbus-daemon --session, is it installed?\n";
+            return 1;
+        }
+        std::printf("DBUS_SESSION_BUS_ADDRESS=%s\n", bus.address().c_str());
+        std::fflush(stdout);
+    }
+
+    MockNotificationServer server(config);
+    std::string error;
+    if (!server.start(bus.address(), &error)) {
+        std::cerr << "mock notification server: " << error << "\n";
+        return 1;
+    }
+    std::cerr << "listening as org.freedesktop.Notifications, ctrl+c to stop\n";
+
+    GMainLoop *loop = g_main_loop_new(nullptr, FALSE);
+    g_unix_signal_add(SIGINT, &quit, loop);
+    g_unix_signal_add(SIGTERM, &quit, loop);
+    if (reportEvery) {
+        g_timeout_add_seconds(reportEvery, [](gpointer server) -> gboolean {
+            printReport(*static_cast<MockNotificationServer *>(server), false);
+            return G_SOURCE_CONTINUE;
+        }, &server);
+    }
+    g_main_loop_run(loop);
+    g_main_loop_unref(loop);
+
+    printReport(server, list);
+    return 0;
+}
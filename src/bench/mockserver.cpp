@@ -0,0 +1,356 @@
+#include "mockserver.h"
+
+#include <algorithm>
+#include <csignal>
+#include <string_view>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+PrivateSessionBus::~PrivateSessionBus() {
+    if (m_pid > 0) {
+        kill(m_pid, SIGTERM);
+        waitpid(m_pid, nullptr, 0);
+    }
+}
+
+bool PrivateSessionBus::start() {
+    int out[2];
+    if (pipe(out) != 0) {
+        return false;
+    }
+    m_pid = fork();
+    if (m_pid < 0) {
+        close(out[0]);
+        close(out[1]);
+        return false;
+    }
+    if (m_pid == 0) {
+        dup2(out[1], STDOUT_FILENO);
+        close(out[0]);
+        close(out[1]);
+        execlp("dbus-daemon", "dbus-daemon", "--session", "--nofork", "--print-address", static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    close(out[1]);
+
+    // the first line it prints is the address to connect to
+    char c;
+    while (read(out[0], &c, 1) == 1 && c != '\n') {
+        m_address += c;
+    }
+    close(out[0]);
+    return !m_address.empty();
+}
+
+namespace {
+
+constexpr const char *introspection =
+    "<node>"
+    "  <interface name='org.freedesktop.Notifications'>"
+    "    <method name='Notify'>"
+    "      <arg type='s' direction='in'/><arg type='u' direction='in'/><arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/><arg type='s' direction='in'/><arg type='as' direction='in'/>"
+    "      <arg type='a{sv}' direction='in'/><arg type='i' direction='in'/>"
+    "      <arg type='u' direction='out'/>"
+    "    </method>"
+    "    <method name='CloseNotification'><arg type='u' direction='in'/></method>"
+    "    <method name='GetCapabilities'><arg type='as' direction='out'/></method>"
+    "    <method name='GetServerInformation'>"
+    "      <arg type='s' direction='out'/><arg type='s' direction='out'/>"
+    "      <arg type='s' direction='out'/><arg type='s' direction='out'/>"
+    "    </method>"
+    "    <signal name='NotificationClosed'><arg type='u'/><arg type='u'/></signal>"
+    "    <signal name='ActionInvoked'><arg type='u'/><arg type='s'/></signal>"
+    "  </interface>"
+    "</node>";
+
+constexpr const char *objectPath = "/org/freedesktop/Notifications";
+constexpr const char *interfaceName = "org.freedesktop.Notifications";
+
+} // namespace
+
+// a Notify thats waiting out its injected latency
+struct MockNotificationServer::PendingReply {
+    MockNotificationServer *server;
+    GDBusMethodInvocation *invocation;
+    std::uint32_t id;
+    bool fail;
+    std::string action; // empty if no ActionInvoked should follow
+};
+
+MockNotificationServer::MockNotificationServer(MockServerConfig config) : m_config(config) {}
+
+MockNotificationServer::~MockNotificationServer() {
+    if (m_loop) {
+        g_main_context_invoke(m_context, &MockNotificationServer::quit, m_loop);
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+gboolean MockNotificationServer::quit(gpointer loop) {
+    g_main_loop_quit(static_cast<GMainLoop *>(loop));
+    return G_SOURCE_REMOVE;
+}
+
+bool MockNotificationServer::start(const std::string &address, std::string *error) {
+    std::promise<bool> ready;
+    std::future<bool> started = ready.get_future();
+    m_thread = std::thread(&MockNotificationServer::run, this, address, error, &ready);
+    bool ok = started.get();
+    if (!ok) {
+        m_thread.join();
+    }
+    return ok;
+}
+
+void MockNotificationServer::run(std::string address, std::string *error, std::promise<bool> *ready) {
+    m_context = g_main_context_new();
+    g_main_context_push_thread_default(m_context);
+
+    GError *gerror = nullptr;
+    if (address.empty()) {
+        m_connection = g_bus_get_sync(G_BUS_TYPE_SESSION, nullptr, &gerror);
+    } else {
+        m_connection = g_dbus_connection_new_for_address_sync(address.c_str(),
+            static_cast<GDBusConnectionFlags>(G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT | G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION),
+            nullptr, nullptr, &gerror);
+    }
+
+    GDBusNodeInfo *node = g_dbus_node_info_new_for_xml(introspection, nullptr);
+    guint registration = 0;
+    bool ok = false;
+    if (m_connection) {
+        static const GDBusInterfaceVTable vtable = {&MockNotificationServer::handleCall, nullptr, nullptr, {}};
+        registration = g_dbus_connection_register_object(m_connection, objectPath, node->interfaces[0], &vtable, this, nullptr, &gerror);
+    }
+    if (registration) {
+        // DBUS_NAME_FLAG_DO_NOT_QUEUE, we want it now or not at all
+        GVariant *reply = g_dbus_connection_call_sync(m_connection, "org.freedesktop.DBus", "/org/freedesktop/DBus",
+            "org.freedesktop.DBus", "RequestName", g_variant_new("(su)", interfaceName, 4u),
+            G_VARIANT_TYPE("(u)"), G_DBUS_CALL_FLAGS_NONE, -1, nullptr, &gerror);
+        if (reply) {
+            guint32 result;
+            g_variant_get(reply, "(u)", &result);
+            ok = result == 1; // primary owner
+            if (!ok && error) {
+                *error = "somebody else already is org.freedesktop.Notifications on that bus";
+            }
+            g_variant_unref(reply);
+        }
+    }
+    if (gerror) {
+        if (error) {
+            *error = gerror->message;
+        }
+        g_error_free(gerror);
+    }
+
+    if (ok) {
+        m_loop = g_main_loop_new(m_context, FALSE);
+    }
+    ready->set_value(ok);
+    if (ok) {
+        g_main_loop_run(m_loop);
+        g_main_loop_unref(m_loop);
+    }
+
+    if (registration) {
+        g_dbus_connection_unregister_object(m_connection, registration);
+    }
+    if (m_connection) {
+        g_dbus_connection_flush_sync(m_connection, nullptr, nullptr);
+        g_object_unref(m_connection);
+        m_connection = nullptr;
+    }
+    g_dbus_node_info_unref(node);
+    g_main_context_pop_thread_default(m_context);
+    g_main_context_unref(m_context);
+}
+
+void MockNotificationServer::handleCall(GDBusConnection *, const gchar *, const gchar *, const gchar *, const gchar *method,
+                                        GVariant *parameters, GDBusMethodInvocation *invocation, gpointer self) {
+    auto *server = static_cast<MockNotificationServer *>(self);
+    std::string_view name = method;
+    if (name == "Notify") {
+        server->handleNotify(invocation, parameters);
+    } else if (name == "CloseNotification") {
+        guint32 id;
+        g_variant_get(parameters, "(u)", &id);
+        {
+            std::lock_guard<std::mutex> lock(server->m_mutex);
+            server->m_stats.closeCalls++;
+        }
+        g_dbus_connection_emit_signal(server->m_connection, nullptr, objectPath, interfaceName, "NotificationClosed",
+                                      g_variant_new("(uu)", id, 3u), nullptr);
+        g_dbus_method_invocation_return_value(invocation, nullptr);
+    } else if (name == "GetCapabilities") {
+        {
+            std::lock_guard<std::mutex> lock(server->m_mutex);
+            server->m_stats.capabilityCalls++;
+        }
+        const gchar *caps[] = {"actions", "body", "body-markup", "body-images", "persistence", nullptr};
+        g_dbus_method_invocation_return_value(invocation, g_variant_new("(^as)", caps));
+    } else if (name == "GetServerInformation") {
+        g_dbus_method_invocation_return_value(invocation, g_variant_new("(ssss)", "thenews-mock", "the news", "1", "1.2"));
+    } else {
+        g_dbus_method_invocation_return_dbus_error(invocation, "org.freedesktop.DBus.Error.UnknownMethod", method);
+    }
+}
+
+void MockNotificationServer::handleNotify(GDBusMethodInvocation *invocation, GVariant *parameters) {
+    const gchar *appName;
+    guint32 replacesId;
+    const gchar *summary;
+    GVariant *actions;
+    GVariant *hints;
+    g_variant_get(parameters, "(&su&s&s@as@a{sv}i)", &appName, &replacesId, nullptr, &summary, nullptr, &actions, &hints, nullptr);
+
+    MockNotification record;
+    record.appName = appName;
+    record.summary = summary;
+    record.replacesId = replacesId;
+    record.actions = g_variant_n_children(actions) / 2; // key, label, key, label...
+    record.payloadBytes = g_variant_get_size(parameters);
+
+    GVariant *imageData = g_variant_lookup_value(hints, "image-data", G_VARIANT_TYPE("(iiibiiay)"));
+    if (!imageData) {
+        imageData = g_variant_lookup_value(hints, "image_data", G_VARIANT_TYPE("(iiibiiay)"));
+    }
+    if (imageData) {
+        GVariant *pixels = g_variant_get_child_value(imageData, 6);
+        record.imageDataBytes = g_variant_get_size(pixels);
+        g_variant_unref(pixels);
+        g_variant_unref(imageData);
+    }
+
+    GVariant *imagePath = g_variant_lookup_value(hints, "image-path", G_VARIANT_TYPE_STRING);
+    if (imagePath) {
+        record.imagePath = true;
+        g_variant_unref(imagePath);
+    }
+
+    std::string action;
+    if (record.actions > 0) {
+        const gchar *key;
+        g_variant_get_child(actions, 0, "&s", &key);
+        action = key;
+    }
+    g_variant_unref(actions);
+    g_variant_unref(hints);
+
+    unsigned delay;
+    bool fail;
+    bool invokeActions;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        record.id = replacesId ? replacesId : ++m_lastId;
+        delay = m_config.latencyMs;
+        if (m_config.jitterMs) {
+            delay += std::uniform_int_distribution<unsigned>(0, m_config.jitterMs)(m_random);
+        }
+        fail = m_config.failureRate > 0 && std::uniform_real_distribution<double>(0, 1)(m_random) < m_config.failureRate;
+        invokeActions = m_config.invokeActions;
+        record.failed = fail;
+
+        m_stats.notifyCalls++;
+        if (fail) {
+            m_stats.failed++;
+        }
+        m_stats.payloadBytes += record.payloadBytes;
+        m_stats.maxPayloadBytes = std::max(m_stats.maxPayloadBytes, record.payloadBytes);
+        if (imageData) {
+            m_stats.withImageData++;
+            m_stats.imageDataBytes += record.imageDataBytes;
+            m_stats.maxImageDataBytes = std::max(m_stats.maxImageDataBytes, record.imageDataBytes);
+        }
+        if (record.imagePath) {
+            m_stats.withImagePath++;
+        }
+        m_stats.pending++;
+
+        if (m_received.size() < recordLimit) {
+            m_received.push_back(record);
+        } else {
+            m_received[m_receivedNext] = record;
+        }
+        m_receivedNext = (m_receivedNext + 1) % recordLimit;
+    }
+
+    auto *pending = new PendingReply{this, invocation, record.id, fail, invokeActions ? action : std::string()};
+    if (delay == 0) {
+        finishNotify(pending);
+        return;
+    }
+    // answer later from the loop, so slow replies overlap like they would
+    // with a real daemon thats busy animating
+    GSource *source = g_timeout_source_new(delay);
+    g_source_set_callback(source, &MockNotificationServer::finishNotify, pending, nullptr);
+    g_source_attach(source, m_context);
+    g_source_unref(source);
+}
+
+gboolean MockNotificationServer::finishNotify(gpointer data) {
+    auto *pending = static_cast<PendingReply *>(data);
+    MockNotificationServer *server = pending->server;
+
+    if (pending->fail) {
+        g_dbus_method_invocation_return_dbus_error(pending->invocation, "org.freedesktop.Notifications.Error.Injected",
+                                                   "the mock server was told to fail this one");
+    } else {
+        g_dbus_method_invocation_return_value(pending->invocation, g_variant_new("(u)", pending->id));
+        if (!pending->action.empty()) {
+            g_dbus_connection_emit_signal(server->m_connection, nullptr, objectPath, interfaceName, "ActionInvoked",
+                                          g_variant_new("(us)", pending->id, pending->action.c_str()), nullptr);
+            // 2 = dismissed by the user
+            g_dbus_connection_emit_signal(server->m_connection, nullptr, objectPath, interfaceName, "NotificationClosed",
+                                          g_variant_new("(uu)", pending->id, 2u), nullptr);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(server->m_mutex);
+        server->m_stats.pending--;
+        if (!pending->fail && !pending->action.empty()) {
+            server->m_stats.actionsInvoked++;
+        }
+    }
+    delete pending;
+    return G_SOURCE_REMOVE;
+}
+
+void MockNotificationServer::setConfig(const MockServerConfig &config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+}
+
+MockServerConfig MockNotificationServer::config() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_config;
+}
+
+MockServerStats MockNotificationServer::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::vector<MockNotification> MockNotificationServer::received() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_received.size() < recordLimit) {
+        return m_received;
+    }
+    std::vector<MockNotification> ordered(m_received.begin() + m_receivedNext, m_received.end());
+    ordered.insert(ordered.end(), m_received.begin(), m_received.begin() + m_receivedNext);
+    return ordered;
+}
+
+void MockNotificationServer::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t pending = m_stats.pending;
+    m_stats = MockServerStats();
+    m_stats.pending = pending;
+    m_received.clear();
+    m_receivedNext = 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <gio/gio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+// a fake org.freedesktop.Notifications for benchmarks and load tests, so
+// sendNotification() can be hammered without a desktop. it runs its own
+// GMainContext on its own thread, remembers what it got sent (including how
+// big the image-data hints were) and can be told to be slow or to fail, to
+// reproduce a notification daemon that cant keep up
+
+// a dbus-daemon --session nobody else knows about, killed again when this goes away
+class PrivateSessionBus {
+public:
+    PrivateSessionBus() = default;
+    ~PrivateSessionBus();
+
+    PrivateSessionBus(const PrivateSessionBus &) = delete;
+    PrivateSessionBus &operator=(const PrivateSessionBus &) = delete;
+
+    bool start();
+    const std::string &address() const { return m_address; }
+
+private:
+    pid_t m_pid = -1;
+    std::string m_address;
+};
+
+struct MockServerConfig {
+    unsigned latencyMs = 0;      // how long every Notify takes to answer
+    unsigned jitterMs = 0;       // plus up to this much more, at random
+    double failureRate = 0;      // 0..1, chance a Notify gets an error back
+    bool invokeActions = false;  // answer every toast that has actions with ActionInvoked on the first one
+};
+
+struct MockNotification {
+    std::string appName;
+    std::string summary;
+    std::uint32_t id = 0;
+    std::uint32_t replacesId = 0;
+    std::size_t actions = 0;
+    std::size_t payloadBytes = 0;   // the whole Notify call, serialized
+    std::size_t imageDataBytes = 0; // just the pixels of the image-data hint
+    bool imagePath = false;         // came with an image-path hint instead
+    bool failed = false;
+};
+
+struct MockServerStats {
+    std::uint64_t notifyCalls = 0;
+    std::uint64_t failed = 0;
+    std::uint64_t closeCalls = 0;
+    std::uint64_t capabilityCalls = 0;
+    std::uint64_t actionsInvoked = 0;
+    std::uint64_t withImageData = 0;
+    std::uint64_t imageDataBytes = 0;
+    std::size_t maxImageDataBytes = 0;
+    std::uint64_t withImagePath = 0;
+    std::uint64_t payloadBytes = 0;
+    std::size_t maxPayloadBytes = 0;
+    std::size_t pending = 0; // Notify calls still waiting out their latency
+};
+
+class MockNotificationServer {
+public:
+    explicit MockNotificationServer(MockServerConfig config = {});
+    ~MockNotificationServer();
+
+    MockNotificationServer(const MockNotificationServer &) = delete;
+    MockNotificationServer &operator=(const MockNotificationServer &) = delete;
+
+    // connects to the bus at address (the session bus if empty) and takes
+    // the org.freedesktop.Notifications name. false if someone already has it
+    bool start(const std::string &address = {}, std::string *error = nullptr);
+
+    void setConfig(const MockServerConfig &config);
+    MockServerConfig config() const;
+
+    MockServerStats stats() const;
+    // the last recordLimit notifications, oldest first
+    std::vector<MockNotification> received() const;
+    void reset();
+
+    static constexpr std::size_t recordLimit = 4096;
+
+private:
+    struct PendingReply;
+
+    void run(std::string address, std::string *error, std::promise<bool> *ready);
+    void handleNotify(GDBusMethodInvocation *invocation, GVariant *parameters);
+    static void handleCall(GDBusConnection *connection, const gchar *sender, const gchar *path, const gchar *interface,
+                           const gchar *method, GVariant *parameters, GDBusMethodInvocation *invocation, gpointer self);
+    static gboolean finishNotify(gpointer pending);
+    static gboolean quit(gpointer loop);
+
+    std::thread m_thread;
+    GMainContext *m_context = nullptr;
+    GMainLoop *m_loop = nullptr;
+    GDBusConnection *m_connection = nullptr;
+
+    mutable std::mutex m_mutex;
+    MockServerConfig m_config;
+    std::mt19937 m_random{std::random_device{}()};
+    std::uint32_t m_lastId = 0;
+    MockServerStats m_stats;
+    std::vector<MockNotification> m_received; // ring buffer of recordLimit
+    std::size_t m_receivedNext = 0;
+};
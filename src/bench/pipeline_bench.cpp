@@ -0,0 +1,312 @@
+// every stage a toast goes through, per notification type:
+//   lookup  findNotification() + notificationDescriptor()
+//   decode  image decode + rgba convert + image-data variant (cold image cache)
+//   build   notify_notification_new() + all the hints, image from a warm cache
+//   show    sendNotification(), a full d-bus round trip
+//   showpath the same, but the image goes as an image-path hint
+// the show stage runs against MockNotificationServer (bench/mockserver.h) in
+// this process, on a private session bus from a dbus-daemon we
+// start ourselves, so the numbers dont depend on whatever desktop you have.
+// --session-bus uses your real session bus and notification daemon instead.
+// --asset-pack FILE adds "mapped" (decode replaced by thenews.pack) and the
+// preload of every image with and without the pack.
+// "burst" sends --burst N toasts (default 2000) back to back through the
+// libnotify backend and then the gdbus one (--dbus-window N calls in
+// flight), with the mock server taking --server-latency MS (default 1) to
+// answer each. ops/s there runs until the last reply is in, the percentiles
+// are how long each sendNotification call held up the caller
+// --json writes the results as json (- for stdout) so runs can be diffed
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../assetpack.h"
+#include "../catalog.h"
+#include "../dbusnotifier.h"
+#include "../imagecache.h"
+#include "../notifications.h"
+#include "../notifybuild.h"
+#include "../percentile.h"
+#include "mockserver.h"
+
+#include <QCoreApplication>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct StageResult {
+    std::string stage;
+    std::string type;
+    std::size_t count = 0;
+    double opsPerSecond = 0;
+    double p50 = 0; // all in microseconds
+    double p90 = 0;
+    double p99 = 0;
+    double max = 0;
+};
+
+template <typename Op>
+StageResult measure(const char *stage, std::string_view type, std::size_t iterations, Op op) {
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    Clock::time_point begin = Clock::now();
+    for (std::size_t i = 0; i < iterations; i++) {
+        Clock::time_point start = Clock::now();
+        op();
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    double total = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    std::sort(samples.begin(), samples.end());
+    StageResult result;
+    result.stage = stage;
+    result.type = std::string(type);
+    result.count = samples.size();
+    result.opsPerSecond = total > 0 ? samples.size() / total : 0;
+    result.p50 = percentile(samples, 0.5);
+    result.p90 = percentile(samples, 0.9);
+    result.p99 = percentile(samples, 0.99);
+    result.max = percentile(samples, 1.0);
+    return result;
+}
+
+// libnotify drops actions that come without a callback, same no-op as sendNotification gives it
+void ignoreAction(NotifyNotification *, char *, gpointer) {}
+
+// what sendNotification builds, short of showing it
+void buildNotification(const NotificationDescriptor &desc) {
+    NotifyNotification *n = newCatalogNotification(desc, ignoreAction);
+    if (desc.image != ResourceId::None) {
+        setNotificationImageFromResource(n, desc.image);
+    }
+    g_object_unref(G_OBJECT(n));
+}
+
+void writeJson(std::ostream &out, const std::vector<StageResult> &results, std::size_t iterations, bool privateBus, std::uint64_t serverCalls) {
+    out << "{\n";
+    out << "  \"iterations\": " << iterations << ",\n";
+    out << "  \"bus\": \"" << (privateBus ? "private" : "session") << "\",\n";
+    if (privateBus) {
+        out << "  \"server_notify_calls\": " << serverCalls << ",\n";
+    }
+    out << "  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const StageResult &r = results[i];
+        out << "    {\"stage\": \"" << r.stage << "\", \"type\": \"" << r.type << "\", \"count\": " << r.count
+            << ", \"ops_per_sec\": " << r.opsPerSecond << ", \"p50_us\": " << r.p50 << ", \"p90_us\": " << r.p90
+            << ", \"p99_us\": " << r.p99 << ", \"max_us\": " << r.max << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::size_t iterations = 200;
+    std::string jsonPath;
+    bool privateBus = true;
+    std::string packPath;
+    std::size_t burst = 2000;
+    unsigned serverLatency = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (arg == "--asset-pack" && i + 1 < argc) {
+            packPath = argv[++i];
+        } else if (arg == "--session-bus") {
+            privateBus = false;
+        } else if (arg == "--burst" && i + 1 < argc) {
+            burst = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--server-latency" && i + 1 < argc) {
+            serverLatency = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--dbus-window" && i + 1 < argc) {
+            DBusNotifier::instance().setWindow(std::strtoull(argv[++i], nullptr, 10));
+        } else {
+            std::cerr << "usage: thenews_bench [--iterations N] [--json FILE|-] [--session-bus] [--asset-pack FILE]\n"
+                         "                     [--burst N] [--server-latency MS] [--dbus-window N]\n";
+            return 1;
+        }
+    }
+
+    // has to happen before libnotify or gio look at the session bus
+    PrivateSessionBus bus;
+    MockNotificationServer server;
+    if (privateBus) {
+        if (!bus.start()) {
+            std::cerr << "couldnt start dbus-daemon --session, is it installed? (or use --session-bus)\n";
+            return 1;
+        }
+        setenv("DBUS_SESSION_BUS_ADDRESS", bus.address().c_str(), 1);
+        std::string error;
+        if (!server.start(bus.address(), &error)) {
+            std::cerr << "mock notification server: " << error << "\n";
+            return 1;
+        }
+    }
+
+    QCoreApplication app(argc, argv);
+    if (!notify_init("the news bench")) {
+        std::cerr << "libnotify is not notifying\n";
+        return 1;
+    }
+
+    // the image stages are a lot slower, no need to run them as often
+    std::size_t imageIterations = std::max<std::size_t>(5, iterations / 10);
+
+    std::vector<StageResult> results;
+    for (const auto &desc : notificationCatalog) {
+        results.push_back(measure("lookup", desc.key, iterations * 100, [&desc]() {
+            NotificationId id;
+            findNotification(desc.key, id);
+            volatile const char *title = notificationDescriptor(id).title;
+            (void)title;
+        }));
+
+        if (desc.image != ResourceId::None) {
+            results.push_back(measure("decode", desc.key, imageIterations, [&desc]() {
+                ImageCache::instance().clear();
+                GVariant *imageData = ImageCache::instance().imageData(desc.image);
+                if (imageData) {
+                    g_variant_unref(imageData);
+                }
+            }));
+        }
+
+        results.push_back(measure("build", desc.key, iterations, [&desc]() {
+            buildNotification(desc);
+        }));
+
+        // this one writes a desktop file into your home, leave it out
+        if (desc.deploysH) {
+            continue;
+        }
+        std::size_t failures = 0;
+        auto show = [&desc, &failures]() {
+            std::string error;
+            if (!sendNotification(desc, &error)) {
+                failures++;
+            }
+        };
+        setNotificationImageMode(NotificationImageMode::Inline);
+        clearNotificationPool();
+        results.push_back(measure("show", desc.key, iterations, show));
+
+        // same thing with the image sent as a file path, see imagefiles.h
+        if (desc.image != ResourceId::None) {
+            setNotificationImageMode(NotificationImageMode::Path);
+            results.push_back(measure("showpath", desc.key, iterations, show));
+        }
+        if (failures) {
+            std::cerr << desc.key << ": " << failures << " shows failed\n";
+        }
+    }
+    setNotificationImageMode(NotificationImageMode::Inline);
+
+    // lots of toasts at once, one reply at a time vs many in flight
+    if (burst > 0) {
+        std::vector<const NotificationDescriptor *> sendable;
+        for (const auto &desc : notificationCatalog) {
+            if (!desc.deploysH) {
+                sendable.push_back(&desc);
+            }
+        }
+        MockServerConfig quick = server.config();
+        if (privateBus) {
+            MockServerConfig slow = quick;
+            slow.latencyMs = serverLatency;
+            server.setConfig(slow);
+        }
+        const NotificationBackend backends[] = {NotificationBackend::Libnotify, NotificationBackend::GDBus};
+        for (NotificationBackend backend : backends) {
+            setNotificationBackend(backend);
+            clearNotificationPool();
+            std::size_t next = 0;
+            std::size_t failures = 0;
+            Clock::time_point begin = Clock::now();
+            StageResult result = measure("burst", backend == NotificationBackend::GDBus ? "gdbus" : "libnotify", burst,
+                                         [&sendable, &next, &failures]() {
+                std::string error;
+                if (!sendNotification(*sendable[next++ % sendable.size()], &error)) {
+                    failures++;
+                }
+            });
+            DBusNotifier::instance().wait();
+            result.opsPerSecond = burst / std::chrono::duration<double>(Clock::now() - begin).count();
+            results.push_back(result);
+            if (failures) {
+                std::cerr << result.type << " burst: " << failures << " sends failed\n";
+            }
+        }
+        setNotificationBackend(NotificationBackend::Libnotify);
+        if (privateBus) {
+            server.setConfig(quick);
+        }
+    }
+
+    // what the daemon and the gui pay up front for every image in the catalog
+    results.push_back(measure("preload", "all", imageIterations, []() {
+        ImageCache::instance().clear();
+        preloadNotificationImages();
+    }));
+
+    // and the same two with the pixels coming out of thenews.pack instead
+    if (!packPath.empty()) {
+        std::string error;
+        if (!AssetPack::instance().open(packPath, &error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        for (const auto &desc : notificationCatalog) {
+            if (desc.image != ResourceId::None) {
+                results.push_back(measure("mapped", desc.key, imageIterations, [&desc]() {
+                    ImageCache::instance().clear();
+                    GVariant *imageData = ImageCache::instance().imageData(desc.image);
+                    if (imageData) {
+                        g_variant_unref(imageData);
+                    }
+                }));
+            }
+        }
+        results.push_back(measure("preloadmapped", "all", imageIterations, []() {
+            ImageCache::instance().clear();
+            preloadNotificationImages();
+        }));
+    }
+
+    if (jsonPath == "-") {
+        writeJson(std::cout, results, iterations, privateBus, server.stats().notifyCalls);
+    } else {
+        std::printf("%-13s %-18s %9s %12s %10s %10s %10s %10s\n", "stage", "type", "count", "ops/s", "p50 us", "p90 us", "p99 us", "max us");
+        for (const auto &r : results) {
+            std::printf("%-13s %-18s %9zu %12.0f %10.2f %10.2f %10.2f %10.2f\n", r.stage.c_str(), r.type.c_str(), r.count,
+                        r.opsPerSecond, r.p50, r.p90, r.p99, r.max);
+        }
+    }
+
+    if (!jsonPath.empty() && jsonPath != "-") {
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "cant write " << jsonPath << "\n";
+            return 1;
+        }
+        writeJson(out, results, iterations, privateBus, server.stats().notifyCalls);
+    }
+
+    clearNotificationPool();
+    notify_uninit();
+    return 0;
+}
@@ -0,0 +1,230 @@
+// stress test for the dispatcher's lanes: a pile of producer threads push
+// toasts of every type into one BoundedQueue per urgency while one consumer
+// empties them critical first, like NotificationDispatcher::drain does. it
+// checks that every producer's toasts come out of each lane in the order they
+// went in (with gaps only where --drop threw some out), and that nothing got
+// lost or duplicated, then prints throughput and how long each lane waited.
+// the same run goes through a mutex + deque queue too for comparison.
+// no libnotify or d-bus involved, exits 1 if anything came out wrong.
+// dispatcher_stress.cpp does the same to the real NotificationDispatcher
+//
+//   thenews_queue_bench [--producers N] [--items N] [--capacity N] [--drop]
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../boundedqueue.h"
+#include "../catalog.h"
+#include "../dispatcher.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Item {
+    std::uint32_t producer;
+    std::uint32_t lane;
+    std::uint64_t sequence; // per producer per lane
+    Clock::time_point pushedAt;
+};
+
+// what the dispatcher used before, same interface as BoundedQueue
+class LockedQueue {
+public:
+    explicit LockedQueue(std::size_t capacity) : m_capacity(capacity) {}
+
+    bool push(const Item &item) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_items.size() >= m_capacity) {
+            return false;
+        }
+        m_items.push_back(item);
+        return true;
+    }
+
+    bool pop(Item &out) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_items.empty()) {
+            return false;
+        }
+        out = m_items.front();
+        m_items.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::deque<Item> m_items;
+    std::size_t m_capacity;
+};
+
+struct Options {
+    std::size_t producers = 8;
+    std::size_t items = 500000; // per producer
+    std::size_t capacity = 1024;
+    bool drop = false;
+};
+
+struct Result {
+    double seconds = 0;
+    std::uint64_t pushed = 0;
+    std::uint64_t popped = 0;
+    std::uint64_t dropped = 0;
+    std::uint64_t outOfOrder = 0;
+    std::array<std::uint64_t, dispatchLaneCount> lanePopped{};
+    std::array<double, dispatchLaneCount> laneWaitUs{};
+};
+
+template <typename Queue>
+Result run(const Options &options) {
+    std::array<std::unique_ptr<Queue>, dispatchLaneCount> lanes;
+    for (auto &lane : lanes) {
+        lane = std::make_unique<Queue>(options.capacity);
+    }
+
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::size_t> producersLeft{options.producers};
+    std::atomic<bool> go{false};
+
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < options.producers; p++) {
+        producers.emplace_back([&, p]() {
+            std::array<std::uint64_t, dispatchLaneCount> sequence{};
+            while (!go) {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i < options.items; i++) {
+                // every producer walks the catalog from a different spot
+                const NotificationDescriptor &desc = notificationCatalog[(i + p * 7) % notificationCount];
+                auto lane = static_cast<std::size_t>(dispatchLane(desc.urgency));
+                Item item{static_cast<std::uint32_t>(p), static_cast<std::uint32_t>(lane), sequence[lane]++, Clock::now()};
+                while (!lanes[lane]->push(item)) {
+                    Item oldest;
+                    if (options.drop && lanes[lane]->pop(oldest)) {
+                        dropped++;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+            producersLeft--;
+        });
+    }
+
+    Result result;
+    std::vector<std::array<std::int64_t, dispatchLaneCount>> lastSeen(options.producers);
+    for (auto &last : lastSeen) {
+        last.fill(-1);
+    }
+
+    auto start = Clock::now();
+    go = true;
+    while (true) {
+        Item item;
+        bool got = false;
+        for (auto &lane : lanes) {
+            if (lane->pop(item)) {
+                got = true;
+                break;
+            }
+        }
+        if (!got) {
+            if (producersLeft == 0) {
+                // one more look, a producer might have pushed right before it finished
+                bool empty = true;
+                for (auto &lane : lanes) {
+                    if (lane->pop(item)) {
+                        got = true;
+                        empty = false;
+                        break;
+                    }
+                }
+                if (empty) {
+                    break;
+                }
+            } else {
+                std::this_thread::yield();
+                continue;
+            }
+        }
+
+        std::int64_t &last = lastSeen[item.producer][item.lane];
+        auto sequence = static_cast<std::int64_t>(item.sequence);
+        if (sequence <= last || (!options.drop && sequence != last + 1)) {
+            result.outOfOrder++;
+        }
+        last = sequence;
+        result.popped++;
+        result.lanePopped[item.lane]++;
+        result.laneWaitUs[item.lane] += std::chrono::duration<double, std::micro>(Clock::now() - item.pushedAt).count();
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    result.pushed = options.producers * options.items;
+    result.dropped = dropped;
+    for (std::size_t i = 0; i < dispatchLaneCount; i++) {
+        if (result.lanePopped[i]) {
+            result.laneWaitUs[i] /= static_cast<double>(result.lanePopped[i]);
+        }
+    }
+    return result;
+}
+
+bool report(const char *name, const Result &result) {
+    std::printf("%-10s %9.0f k pushes/s  %llu pushed, %llu popped, %llu dropped, %llu out of order\n", name,
+                static_cast<double>(result.pushed) / result.seconds / 1000, static_cast<unsigned long long>(result.pushed),
+                static_cast<unsigned long long>(result.popped), static_cast<unsigned long long>(result.dropped),
+                static_cast<unsigned long long>(result.outOfOrder));
+    for (std::size_t i = 0; i < dispatchLaneCount; i++) {
+        std::printf("  %-9s %10llu toasts, %9.1f us average wait\n", dispatchLaneName(static_cast<DispatchLane>(i)),
+                    static_cast<unsigned long long>(result.lanePopped[i]), result.laneWaitUs[i]);
+    }
+
+    bool ok = result.outOfOrder == 0 && result.popped + result.dropped == result.pushed;
+    if (!ok) {
+        std::printf("  FAILED: %s\n", result.outOfOrder ? "toasts came out of a lane out of order" : "toasts got lost or duplicated");
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--producers" && i + 1 < argc) {
+            options.producers = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--items" && i + 1 < argc) {
+            options.items = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--capacity" && i + 1 < argc) {
+            options.capacity = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--drop") {
+            options.drop = true;
+        } else {
+            std::fprintf(stderr, "usage: thenews_queue_bench [--producers N] [--items N] [--capacity N] [--drop]\n");
+            return 1;
+        }
+    }
+    options.producers = std::max<std::size_t>(options.producers, 1);
+
+    std::printf("%zu producers x %zu toasts, %zu per lane%s\n", options.producers, options.items, options.capacity,
+                options.drop ? ", dropping the oldest when full" : "");
+    bool ok = report("lock-free", run<BoundedQueue<Item>>(options));
+    ok = report("mutex", run<LockedQueue>(options)) && ok;
+    return ok ? 0 : 1;
+}
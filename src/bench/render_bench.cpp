@@ -0,0 +1,443 @@
+// frame times for the two pages of the real NewsWindow, offscreen. every
+// page gets rendered at each window size and device pixel ratio, first the
+// whole window again and again ("full"), then a fake mouse goes over every
+// visible button and each hover, press and release repaints just that
+// button's rect, backgrounds under it included ("hover"). each line is the
+// per frame paint time and how many mallocs a frame did:
+//
+//   thenews_render_bench [--frames N] [--rounds N] [--sizes 815x471,1280x720]
+//                        [--dprs 1,1.5,2] [--save-baseline FILE]
+//                        [--baseline FILE] [--tolerance PCT] [--max-frame-ms MS]
+//
+// --save-baseline writes the numbers out, --baseline compares against them
+// and exits 1 if a p50 got more than --tolerance percent (default 25) slower
+// or a frame does more mallocs than it used to. --max-frame-ms fails any p99
+// over it regardless. the pages are a fixed 815x471, bigger windows just
+// have more window around them. presses get released off the button so
+// nothing actually sends a toast. the widgets cache their pixmaps for
+// whatever devicePixelRatioF() says, so each ratio runs in a process of its
+// own with QT_SCALE_FACTOR set before qt starts, the rest just collects
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../dispatcher.h"
+#include "../newswindow.h"
+#include "../percentile.h"
+#include "../startupprofile.h"
+
+#include <QAbstractButton>
+#include <QApplication>
+#include <QEnterEvent>
+#include <QEvent>
+#include <QImage>
+#include <QMouseEvent>
+#include <QRegion>
+#include <QStackedWidget>
+
+extern char **environ;
+
+// every malloc in the process, qt's containers and images dont go through
+// operator new so counting that would miss most of them
+namespace {
+std::atomic<std::uint64_t> mallocs{0};
+}
+
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *pointer, std::size_t size);
+
+void *malloc(std::size_t size) {
+    mallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) {
+    mallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, std::size_t size) {
+    mallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    int frames = 50;
+    int rounds = 5;
+    std::vector<QSize> sizes = {QSize(815, 471), QSize(1280, 720), QSize(1920, 1080)};
+    std::vector<double> dprs = {1, 1.5, 2};
+    std::string saveBaseline;
+    std::string baseline;
+    double tolerance = 25;
+    double maxFrameMs = 0;
+    // set in the process that does one ratio, where its results go
+    std::string results;
+};
+
+struct FrameStats {
+    std::vector<double> us;
+    std::uint64_t mallocs = 0;
+
+    double mallocsPerFrame() const {
+        return us.empty() ? 0 : static_cast<double>(mallocs) / static_cast<double>(us.size());
+    }
+};
+
+struct Result {
+    std::string key; // "page1 815x471@1.5 hover"
+    double p50 = 0;
+    double p99 = 0;
+    double max = 0;
+    double mallocsPerFrame = 0;
+};
+
+// one frame: source (window coordinates) painted into the image
+void renderFrame(QWidget &window, QImage &image, const QRect &source, FrameStats &stats) {
+    std::uint64_t before = mallocs.load(std::memory_order_relaxed);
+    auto start = Clock::now();
+    window.render(&image, source.topLeft(), QRegion(source));
+    stats.us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    stats.mallocs += mallocs.load(std::memory_order_relaxed) - before;
+}
+
+// what qt would send for a real mouse, QApplication sets WA_UnderMouse
+// itself when it dispatches enter/leave so that has to be faked too or the
+// :hover styles never kick in
+void hover(QAbstractButton *button, const QPointF &local, const QPointF &windowPos, const QPointF &globalPos) {
+    button->setAttribute(Qt::WA_UnderMouse, true);
+    QEnterEvent enter(local, windowPos, globalPos);
+    QApplication::sendEvent(button, &enter);
+    QMouseEvent move(QEvent::MouseMove, local, windowPos, globalPos, Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+    QApplication::sendEvent(button, &move);
+}
+
+void press(QAbstractButton *button, const QPointF &local, const QPointF &windowPos, const QPointF &globalPos) {
+    QMouseEvent event(QEvent::MouseButtonPress, local, windowPos, globalPos, Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
+    QApplication::sendEvent(button, &event);
+}
+
+// let go off the button, a release on it would be a click
+void releaseAndLeave(QAbstractButton *button, const QPointF &globalPos) {
+    QPointF outside(-1, -1);
+    QMouseEvent release(QEvent::MouseButtonRelease, outside, outside, globalPos, Qt::LeftButton, Qt::NoButton, Qt::NoModifier);
+    QApplication::sendEvent(button, &release);
+    button->setAttribute(Qt::WA_UnderMouse, false);
+    QEvent leave(QEvent::Leave);
+    QApplication::sendEvent(button, &leave);
+}
+
+std::vector<QAbstractButton *> visibleButtons(QWidget *page) {
+    std::vector<QAbstractButton *> buttons;
+    for (QAbstractButton *button : page->findChildren<QAbstractButton *>()) {
+        if (button->isVisible()) {
+            buttons.push_back(button);
+        }
+    }
+    return buttons;
+}
+
+Result finish(const std::string &key, FrameStats &stats) {
+    Result result;
+    result.key = key;
+    result.p50 = percentile(stats.us, 0.5);
+    result.p99 = percentile(stats.us, 0.99);
+    result.max = percentile(stats.us, 1.0);
+    result.mallocsPerFrame = stats.mallocsPerFrame();
+    std::printf("%-28s %6zu frames  p50 %9.1f us  p99 %9.1f us  max %9.1f us  %8.1f mallocs/frame\n", key.c_str(),
+                stats.us.size(), result.p50, result.p99, result.max, result.mallocsPerFrame);
+    return result;
+}
+
+void benchPage(QApplication &app, NewsWindow &window, const char *pageName, const Options &options, std::vector<Result> &results) {
+    for (QSize size : options.sizes) {
+        window.resize(size);
+        app.processEvents();
+        QWidget *page = qobject_cast<QStackedWidget *>(window.centralWidget())->currentWidget();
+        std::vector<QAbstractButton *> buttons = visibleButtons(page);
+
+        // same ratio the widgets see, so they paint straight from their caches
+        qreal dpr = window.devicePixelRatioF();
+        QImage image(window.size() * dpr, QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(dpr);
+        image.fill(Qt::transparent);
+
+        char prefix[64];
+        std::snprintf(prefix, sizeof(prefix), "%s %dx%d@%g", pageName, size.width(), size.height(), dpr);
+
+        // first one polishes and fills whatever caches there are, dont count it
+        FrameStats warmup;
+        renderFrame(window, image, window.rect(), warmup);
+
+        FrameStats full;
+        for (int i = 0; i < options.frames; i++) {
+            renderFrame(window, image, window.rect(), full);
+        }
+        results.push_back(finish(std::string(prefix) + " full", full));
+
+        FrameStats hovered;
+        for (int round = 0; round < options.rounds; round++) {
+            for (QAbstractButton *button : buttons) {
+                QRect rect(button->mapTo(&window, QPoint(0, 0)), button->size());
+                QPointF local = QRectF(button->rect()).center();
+                QPointF windowPos = QRectF(rect).center();
+                QPointF globalPos = window.mapToGlobal(windowPos);
+
+                hover(button, local, windowPos, globalPos);
+                renderFrame(window, image, rect, hovered);
+                press(button, local, windowPos, globalPos);
+                renderFrame(window, image, rect, hovered);
+                releaseAndLeave(button, globalPos);
+                renderFrame(window, image, rect, hovered);
+            }
+        }
+        results.push_back(finish(std::string(prefix) + " hover", hovered));
+        // the update()s the events queued up, so they dont pile into the next size
+        app.processEvents();
+    }
+}
+
+std::vector<QSize> parseSizes(const char *text) {
+    std::vector<QSize> sizes;
+    std::stringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        int width = 0;
+        int height = 0;
+        if (std::sscanf(item.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0) {
+            sizes.emplace_back(width, height);
+        }
+    }
+    return sizes;
+}
+
+std::vector<double> parseDprs(const char *text) {
+    std::vector<double> dprs;
+    std::stringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        double dpr = std::strtod(item.c_str(), nullptr);
+        if (dpr > 0) {
+            dprs.push_back(dpr);
+        }
+    }
+    return dprs;
+}
+
+// "key\tp50\tp99\tmallocs" per line
+bool saveBaseline(const std::string &path, const std::vector<Result> &results) {
+    std::ofstream out(path);
+    for (const Result &result : results) {
+        out << result.key << "\t" << result.p50 << "\t" << result.p99 << "\t" << result.mallocsPerFrame << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool loadResults(const std::string &path, std::vector<Result> &results) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        std::stringstream fields(line);
+        Result result;
+        if (std::getline(fields, result.key, '\t') && fields >> result.p50 >> result.p99 >> result.mallocsPerFrame) {
+            results.push_back(result);
+        }
+    }
+    return true;
+}
+
+bool loadBaseline(const std::string &path, std::map<std::string, Result> &baseline) {
+    std::vector<Result> results;
+    if (!loadResults(path, results)) {
+        return false;
+    }
+    for (const Result &result : results) {
+        baseline[result.key] = result;
+    }
+    return true;
+}
+
+// the windows and their caches for one ratio, in this process
+int renderOneRatio(int argc, char *argv[], const Options &options) {
+    // same frames with or without a display
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    // nothing gets sent, the window just wants one
+    NotificationDispatcher dispatcher;
+    StartupProfile profile;
+    NewsWindow window(dispatcher, profile);
+    window.show();
+    app.processEvents();
+
+    // a rounding policy from the environment would measure some other ratio under this ones name
+    double asked = qEnvironmentVariableIsSet("QT_SCALE_FACTOR") ? qgetenv("QT_SCALE_FACTOR").toDouble() : 1;
+    if (std::abs(window.devicePixelRatioF() - asked) > 0.001) {
+        std::fprintf(stderr, "asked qt for a ratio of %g and got %g\n", asked, window.devicePixelRatioF());
+        return 1;
+    }
+
+    std::vector<Result> results;
+    benchPage(app, window, "page1", options, results);
+    window.showPage(1);
+    app.processEvents();
+    benchPage(app, window, "page2", options, results);
+
+    if (!saveBaseline(options.results, results)) {
+        std::fprintf(stderr, "couldnt write %s\n", options.results.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+// runs this same binary for one ratio and reads back what it measured
+bool spawnRatio(double dpr, const Options &options, std::vector<Result> &results) {
+    char path[] = "/tmp/thenews_render_bench.XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        std::fprintf(stderr, "couldnt make a temporary file for the results\n");
+        return false;
+    }
+    ::close(fd);
+
+    std::string sizes;
+    for (QSize size : options.sizes) {
+        sizes += (sizes.empty() ? "" : ",") + std::to_string(size.width()) + "x" + std::to_string(size.height());
+    }
+    std::string frames = std::to_string(options.frames);
+    std::string rounds = std::to_string(options.rounds);
+    char exe[] = "/proc/self/exe";
+    char framesFlag[] = "--frames";
+    char roundsFlag[] = "--rounds";
+    char sizesFlag[] = "--sizes";
+    char resultsFlag[] = "--results";
+    char *args[] = {exe, framesFlag, frames.data(), roundsFlag, rounds.data(), sizesFlag, sizes.data(),
+                    resultsFlag, path, nullptr};
+
+    // qt reads it once while the QApplication gets built, it has to be in
+    // the environment before that, which is why its a whole process
+    char scale[32];
+    std::snprintf(scale, sizeof(scale), "%g", dpr);
+    setenv("QT_SCALE_FACTOR", scale, 1);
+    std::fflush(stdout);
+    pid_t pid;
+    int status = 0;
+    bool ok = posix_spawn(&pid, exe, nullptr, nullptr, args, environ) == 0 && waitpid(pid, &status, 0) >= 0 &&
+              WIFEXITED(status) && WEXITSTATUS(status) == 0 && loadResults(path, results);
+    unsetenv("QT_SCALE_FACTOR");
+    unlink(path);
+    if (!ok) {
+        std::fprintf(stderr, "rendering at %g didnt work out\n", dpr);
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--rounds" && i + 1 < argc) {
+            options.rounds = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--sizes" && i + 1 < argc) {
+            options.sizes = parseSizes(argv[++i]);
+        } else if (arg == "--dprs" && i + 1 < argc) {
+            options.dprs = parseDprs(argv[++i]);
+        } else if (arg == "--save-baseline" && i + 1 < argc) {
+            options.saveBaseline = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            options.baseline = argv[++i];
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            options.tolerance = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--max-frame-ms" && i + 1 < argc) {
+            options.maxFrameMs = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--results" && i + 1 < argc) {
+            options.results = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: thenews_render_bench [--frames N] [--rounds N] [--sizes WxH,...] [--dprs D,...]\n"
+                                 "                            [--save-baseline FILE] [--baseline FILE] [--tolerance PCT] [--max-frame-ms MS]\n");
+            return 1;
+        }
+    }
+    if (options.sizes.empty() || options.dprs.empty()) {
+        std::fprintf(stderr, "nothing to render, check --sizes and --dprs\n");
+        return 1;
+    }
+    if (!options.results.empty()) {
+        return renderOneRatio(argc, argv, options);
+    }
+
+    std::map<std::string, Result> baseline;
+    if (!options.baseline.empty() && !loadBaseline(options.baseline, baseline)) {
+        std::fprintf(stderr, "couldnt read %s\n", options.baseline.c_str());
+        return 1;
+    }
+
+    std::vector<Result> results;
+    for (double dpr : options.dprs) {
+        if (!spawnRatio(dpr, options, results)) {
+            return 1;
+        }
+    }
+
+    if (!options.saveBaseline.empty() && !saveBaseline(options.saveBaseline, results)) {
+        std::fprintf(stderr, "couldnt write %s\n", options.saveBaseline.c_str());
+        return 1;
+    }
+
+    int regressions = 0;
+    for (const Result &result : results) {
+        if (options.maxFrameMs > 0 && result.p99 > options.maxFrameMs * 1000) {
+            std::printf("REGRESSION %s: p99 %.1f us is over %.1f ms\n", result.key.c_str(), result.p99, options.maxFrameMs);
+            regressions++;
+        }
+        auto it = baseline.find(result.key);
+        if (it == baseline.end()) {
+            continue;
+        }
+        const Result &before = it->second;
+        if (result.p50 > before.p50 * (1 + options.tolerance / 100)) {
+            std::printf("REGRESSION %s: p50 %.1f us, was %.1f us\n", result.key.c_str(), result.p50, before.p50);
+            regressions++;
+        }
+        // a fraction of a malloc is just noise from rounding the average
+        if (result.mallocsPerFrame > before.mallocsPerFrame + 0.5) {
+            std::printf("REGRESSION %s: %.1f mallocs/frame, was %.1f\n", result.key.c_str(), result.mallocsPerFrame,
+                        before.mallocsPerFrame);
+            regressions++;
+        }
+    }
+    if (!baseline.empty() || options.maxFrameMs > 0) {
+        std::printf("%d regression%s\n", regressions, regressions == 1 ? "" : "s");
+    }
+    return regressions > 0 ? 1 : 0;
+}
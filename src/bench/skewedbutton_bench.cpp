@@ -0,0 +1,220 @@
+// how long does a SkewedButton repaint take? "legacy" is the old paintEvent
+// that rebuilt the transform and drew everything every time, "cached" is
+// SkewedButton now (one pixmap blit). run with QT_QPA_PLATFORM=offscreen
+//
+// the second part sweeps a fake mouse over the whole bounding box of the
+// button and counts repaints and clicks. the legacy one repaints on every
+// enter/leave of the box, the new one only when the skewed shape is crossed
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "../skewedbutton.h"
+
+#include <QApplication>
+#include <QEnterEvent>
+#include <QEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPushButton>
+#include <QWidget>
+#include <QtMath>
+
+namespace {
+
+// the old SkewedButton, geometry setup left out since both get the same one
+class LegacySkewedButton : public QPushButton {
+public:
+    LegacySkewedButton(QWidget *parent, double skewX, double skewY, double rotation)
+        : QPushButton(parent), m_skewX(skewX), m_skewY(skewY), m_rotation(rotation) {}
+
+protected:
+    void enterEvent(QEnterEvent *event) override {
+        update();
+        QPushButton::enterEvent(event);
+    }
+
+    void leaveEvent(QEvent *event) override {
+        update();
+        QPushButton::leaveEvent(event);
+    }
+
+    void mousePressEvent(QMouseEvent *event) override {
+        update();
+        QPushButton::mousePressEvent(event);
+    }
+
+    void mouseReleaseEvent(QMouseEvent *event) override {
+        update();
+        QPushButton::mouseReleaseEvent(event);
+    }
+
+    void paintEvent(QPaintEvent *) override {
+        QPainter painter(this);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+        QTransform transform;
+        QRectF drawRect = rect();
+        QPointF center(drawRect.center());
+        transform.translate(center.x(), center.y());
+        if (m_rotation != 0) {
+            transform.rotate(m_rotation);
+        }
+        double shearX = qTan(qDegreesToRadians(m_skewX));
+        double shearY = qTan(qDegreesToRadians(m_skewY));
+        transform.shear(shearX, shearY);
+        transform.translate(-center.x(), -center.y());
+        painter.setTransform(transform);
+
+        QColor bgColor = palette().color(QPalette::Active, QPalette::Button);
+        if (isDown()) {
+            bgColor = bgColor.darker(120);
+        } else if (underMouse()) {
+            bgColor = bgColor.lighter(110);
+        }
+
+        painter.fillRect(drawRect.toRect(), bgColor);
+        painter.setPen(QPen(Qt::black, 1));
+        painter.drawRect(drawRect.toRect().adjusted(0, 0, -1, -1));
+        painter.setPen(palette().color(QPalette::ButtonText));
+        painter.setFont(font());
+        painter.drawText(drawRect.toRect(), Qt::AlignCenter, text());
+    }
+
+private:
+    double m_skewX;
+    double m_skewY;
+    double m_rotation;
+};
+
+double usPerRepaint(QWidget *button, int repaints) {
+    // first one fills the pixmap cache, dont count it
+    button->repaint();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repaints; i++) {
+        button->repaint();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / repaints;
+}
+
+class PaintCounter : public QObject {
+public:
+    int paints = 0;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override {
+        if (event->type() == QEvent::Paint) {
+            paints++;
+        }
+        return QObject::eventFilter(watched, event);
+    }
+};
+
+struct SweepResult {
+    int paints = 0;
+    int clicks = 0;
+};
+
+// moves over the bounding box of button in 2px steps and clicks everywhere,
+// sending enter/leave to whatever childAt() says is under the mouse like
+// qt does for real mouse input
+SweepResult sweep(QApplication &app, QWidget &window, QPushButton *button) {
+    SweepResult result;
+    PaintCounter counter;
+    QObject::connect(button, &QPushButton::clicked, [&result]() {
+        result.clicks++;
+    });
+    app.processEvents();
+    button->installEventFilter(&counter);
+
+    QWidget *under = nullptr;
+    QRect area = button->geometry();
+    for (int y = area.top(); y <= area.bottom(); y += 2) {
+        for (int x = area.left(); x <= area.right(); x += 2) {
+            QPoint windowPos(x, y);
+            QPointF globalPos = window.mapToGlobal(QPointF(windowPos));
+            QWidget *target = window.childAt(windowPos);
+            QPointF local = target ? target->mapFrom(&window, QPointF(windowPos)) : QPointF();
+
+            if (target != under) {
+                if (under) {
+                    QEvent leave(QEvent::Leave);
+                    QApplication::sendEvent(under, &leave);
+                }
+                if (target) {
+                    QEnterEvent enter(local, QPointF(windowPos), globalPos);
+                    QApplication::sendEvent(target, &enter);
+                }
+                under = target;
+            }
+            if (target == button) {
+                QMouseEvent move(QEvent::MouseMove, local, QPointF(windowPos), globalPos, Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+                QApplication::sendEvent(button, &move);
+                QMouseEvent press(QEvent::MouseButtonPress, local, QPointF(windowPos), globalPos, Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
+                QApplication::sendEvent(button, &press);
+                QMouseEvent release(QEvent::MouseButtonRelease, local, QPointF(windowPos), globalPos, Qt::LeftButton, Qt::NoButton, Qt::NoModifier);
+                QApplication::sendEvent(button, &release);
+            }
+            app.processEvents();
+        }
+    }
+    if (under) {
+        QEvent leave(QEvent::Leave);
+        QApplication::sendEvent(under, &leave);
+    }
+    app.processEvents();
+
+    button->removeEventFilter(&counter);
+    result.paints = counter.paints;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    int repaints = 5000;
+    if (argc > 1) {
+        repaints = std::stoi(argv[1]);
+    }
+
+    QApplication app(argc, argv);
+
+    QWidget window;
+    window.resize(805, 505);
+
+    // same numbers as the donation tile on page 1
+    LegacySkewedButton *legacy = new LegacySkewedButton(&window, 0, 29.612, 31.3);
+    legacy->setGeometry(20, 20, 240, 120);
+    legacy->setText("donate to the news");
+
+    SkewedButton *cached = new SkewedButton(&window);
+    cached->setGeometry(300, 20, 240, 120);
+    cached->setText("donate to the news");
+    cached->setSkewTransform(0, 29.612, -11.22, 18.454, 31.3);
+
+    window.show();
+    app.processEvents();
+
+    double legacyUs = usPerRepaint(legacy, repaints);
+    double cachedUs = usPerRepaint(cached, repaints);
+
+    std::cout << "SkewedButton paint, " << repaints << " repaints at dpr " << window.devicePixelRatioF() << "\n";
+    std::cout << "  legacy paintEvent: " << legacyUs << " us/repaint\n";
+    std::cout << "  cached pixmap:     " << cachedUs << " us/repaint\n";
+
+    // same bounding box for both so the sweep covers the same ground, far
+    // enough apart that they dont overlap
+    window.resize(1200, 900);
+    legacy->setGeometry(cached->geometry().translated(0, 450));
+    SweepResult legacySweep = sweep(app, window, legacy);
+    SweepResult cachedSweep = sweep(app, window, cached);
+
+    QRect box = cached->geometry();
+    std::cout << "mouse sweep over the " << box.width() << "x" << box.height() << " bounding box\n";
+    std::cout << "  legacy: " << legacySweep.paints << " repaints, " << legacySweep.clicks << " clicks\n";
+    std::cout << "  shaped: " << cachedSweep.paints << " repaints, " << cachedSweep.clicks << " clicks\n";
+    return 0;
+}
@@ -0,0 +1,135 @@
+// what a cli toast costs from exec to exit: runs each command --runs times
+// (default 20) against MockNotificationServer on a private session bus and
+// prints the median and p90 wall time and the peak rss the kernel saw.
+// without commands it compares the two ways of sending one toast from the
+// build directory, thenews (qt) and thenews-notify (no qt):
+//
+//   thenews_startup_bench [--runs N] [--session-bus] [-- CMD ARG... [-- CMD ARG...]]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../percentile.h"
+#include "mockserver.h"
+
+namespace {
+
+struct Run {
+    double ms;
+    long rssKiB;
+    bool ok;
+};
+
+Run runOnce(const std::vector<std::string> &command) {
+    std::vector<char *> args;
+    for (const auto &arg : command) {
+        args.push_back(const_cast<char *>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        // "h deployed at" and friends arent what were measuring
+        int null = open("/dev/null", O_WRONLY);
+        if (null >= 0) {
+            dup2(null, STDOUT_FILENO);
+        }
+        execv(args[0], args.data());
+        _exit(127);
+    }
+
+    int status = 0;
+    rusage usage{};
+    wait4(pid, &status, 0, &usage);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return {ms, usage.ru_maxrss, pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0};
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::size_t runs = 20;
+    bool privateBus = true;
+    std::vector<std::vector<std::string>> commands;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            runs = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--session-bus") {
+            privateBus = false;
+        } else if (arg == "--") {
+            commands.emplace_back();
+        } else if (!commands.empty()) {
+            commands.back().emplace_back(arg);
+        } else {
+            std::cerr << "usage: thenews_startup_bench [--runs N] [--session-bus] [-- CMD ARG... [-- CMD ARG...]]\n";
+            return 1;
+        }
+    }
+    if (commands.empty()) {
+        std::error_code error;
+        std::filesystem::path dir = std::filesystem::read_symlink("/proc/self/exe", error).parent_path();
+        commands.push_back({(dir / "thenews").string(), "--someoneDied"});
+        commands.push_back({(dir / "thenews-notify").string(), "--someoneDied"});
+    }
+
+    PrivateSessionBus bus;
+    MockNotificationServer server;
+    if (privateBus) {
+        if (!bus.start()) {
+            std::cerr << "couldnt start dbus-daemon --session, is it installed? (or use --session-bus)\n";
+            return 1;
+        }
+        setenv("DBUS_SESSION_BUS_ADDRESS", bus.address().c_str(), 1);
+        std::string error;
+        if (!server.start(bus.address(), &error)) {
+            std::cerr << "mock notification server: " << error << "\n";
+            return 1;
+        }
+    }
+
+    std::printf("%-40s %6s %10s %10s %10s\n", "command", "runs", "p50 ms", "p90 ms", "rss KiB");
+    for (const auto &command : commands) {
+        if (command.empty()) {
+            continue;
+        }
+        // one to get everything into the page cache, its cold start in the
+        // sense of a new process, not of a cold disk
+        runOnce(command);
+
+        std::vector<double> times;
+        std::vector<double> rss;
+        std::size_t failures = 0;
+        for (std::size_t i = 0; i < runs; i++) {
+            Run run = runOnce(command);
+            times.push_back(run.ms);
+            rss.push_back(static_cast<double>(run.rssKiB));
+            failures += run.ok ? 0 : 1;
+        }
+
+        std::string name;
+        for (const auto &arg : command) {
+            name += (name.empty() ? std::filesystem::path(arg).filename().string() : " " + arg);
+        }
+        std::printf("%-40s %6zu %10.2f %10.2f %10.0f\n", name.c_str(), runs, percentile(times, 0.5), percentile(times, 0.9),
+                    percentile(rss, 0.5));
+        if (failures) {
+            std::printf("  %zu runs failed\n", failures);
+        }
+    }
+    return 0;
+}
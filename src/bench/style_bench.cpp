@@ -0,0 +1,133 @@
+// how long does styling the news buttons take, and how much memory does it
+// cost? "legacy" gives every button its own stylesheet like
+// addHoverEffect + addConsistentStyle did, "shared" uses
+// applyNewsButtonStyle(). run each mode in its own process so they dont see
+// each others stylesheets, with QT_QPA_PLATFORM=offscreen if theres no display:
+//   thenews_style_bench legacy 20
+//   thenews_style_bench shared 20
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../newsstyle.h"
+
+#include <QApplication>
+#include <QColor>
+#include <QPalette>
+#include <QPushButton>
+#include <QWidget>
+
+namespace {
+
+long residentKiB() {
+    std::ifstream statm("/proc/self/statm");
+    long size = 0;
+    long resident = 0;
+    statm >> size >> resident;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+void addHoverEffect(QPushButton *btn) {
+    btn->setStyleSheet(
+        "QPushButton { background-color: rgba(116, 125, 136, 100); color: black; }"
+        "QPushButton:hover { background-color: rgba(130, 140, 150, 100); }"
+        "QPushButton:pressed { background-color: rgba(100, 110, 120, 100); }"
+    );
+}
+
+void addConsistentStyle(QPushButton *btn) {
+    QPalette palette = btn->palette();
+    QColor baseColor = palette.color(QPalette::Button);
+    baseColor.setAlpha(100);
+
+    QColor hoverColor = baseColor.lighter(110);
+    hoverColor.setAlpha(100);
+
+    QColor pressColor = baseColor.darker(120);
+    pressColor.setAlpha(100);
+
+    btn->setStyleSheet(
+        QString("QPushButton { "
+                "background-color: rgba(%1, %2, %3, %4); "
+                "color: black; "
+                "border: 1px solid black; "
+                "} "
+                "QPushButton:hover { "
+                "background-color: rgba(%5, %6, %7, %8); "
+                "} "
+                "QPushButton:pressed { "
+                "background-color: rgba(%9, %10, %11, %12); "
+                "}")
+            .arg(baseColor.red()).arg(baseColor.green()).arg(baseColor.blue()).arg(baseColor.alpha())
+            .arg(hoverColor.red()).arg(hoverColor.green()).arg(hoverColor.blue()).arg(hoverColor.alpha())
+            .arg(pressColor.red()).arg(pressColor.green()).arg(pressColor.blue()).arg(pressColor.alpha())
+    );
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || (std::strcmp(argv[1], "legacy") != 0 && std::strcmp(argv[1], "shared") != 0)) {
+        std::cerr << "usage: thenews_style_bench legacy|shared [buttons]\n";
+        return 1;
+    }
+    bool legacy = std::strcmp(argv[1], "legacy") == 0;
+    int buttonCount = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    QApplication app(argc, argv);
+
+    QWidget window;
+    window.resize(805, 505);
+
+    // same palette the .ui files give the tiles
+    QPalette tilePalette;
+    tilePalette.setColor(QPalette::Button, QColor(116, 125, 136, 100));
+
+    std::vector<QPushButton *> buttons;
+    for (int i = 0; i < buttonCount; i++) {
+        QPushButton *btn = new QPushButton(QString("button %1").arg(i), &window);
+        btn->setGeometry((i % 5) * 160, (i / 5) * 60, 150, 50);
+        btn->setPalette(tilePalette);
+        buttons.push_back(btn);
+    }
+
+    long rssBefore = residentKiB();
+    auto start = std::chrono::steady_clock::now();
+
+    for (QPushButton *btn : buttons) {
+        if (legacy) {
+            addHoverEffect(btn);
+            addConsistentStyle(btn);
+        } else {
+            applyNewsButtonStyle(btn);
+        }
+    }
+    auto styled = std::chrono::steady_clock::now();
+
+    for (QPushButton *btn : buttons) {
+        btn->ensurePolished();
+    }
+    auto polished = std::chrono::steady_clock::now();
+
+    window.show();
+    app.processEvents();
+    auto shown = std::chrono::steady_clock::now();
+    long rssAfter = residentKiB();
+
+    auto ms = [](auto duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+
+    std::cout << argv[1] << " styling, " << buttonCount << " buttons\n";
+    std::cout << "  set stylesheets: " << ms(styled - start) << " ms\n";
+    std::cout << "  polish:          " << ms(polished - styled) << " ms\n";
+    std::cout << "  show + paint:    " << ms(shown - polished) << " ms\n";
+    std::cout << "  rss growth:      " << rssAfter - rssBefore << " KiB\n";
+    return 0;
+}
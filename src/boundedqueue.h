@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// fixed size lock-free queue (dmitry vyukov's bounded mpmc ring). any number
+// of threads can push, and popping is safe from more than one thread too,
+// which the dispatcher needs: the sender is the one real consumer, but a
+// producer that finds its lane full pops the oldest toast to make room.
+// every slot has a sequence number that says whose turn it is, so push and
+// pop are one compare-and-swap each and nobody ever waits on a lock.
+// T gets copied in and out, keep it small
+
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity)
+        : m_capacity(capacity > 0 ? capacity : 1),
+          m_slots(new Slot[m_capacity]) {
+        for (std::size_t i = 0; i < m_capacity; i++) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    // false if its full
+    bool push(const T &value) {
+        std::size_t position = m_head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot &slot = m_slots[position % m_capacity];
+            std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                // the slot still holds what was pushed a lap ago
+                return false;
+            } else {
+                position = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // false if its empty
+    bool pop(T &out) {
+        std::size_t position = m_tail.load(std::memory_order_relaxed);
+        while (true) {
+            Slot &slot = m_slots[position % m_capacity];
+            std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (difference == 0) {
+                if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    out = slot.value;
+                    slot.sequence.store(position + m_capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // only a snapshot, it can be stale by the time you look at it
+    std::size_t size() const {
+        std::size_t tail = m_tail.load(std::memory_order_acquire);
+        std::size_t head = m_head.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+    std::size_t capacity() const {
+        return m_capacity;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::size_t m_capacity;
+    std::unique_ptr<Slot[]> m_slots;
+    // on their own cache lines so producers and the consumer dont fight over one
+    alignas(64) std::atomic<std::size_t> m_head{0}; // next slot to push into
+    alignas(64) std::atomic<std::size_t> m_tail{0}; // next slot to pop from
+};
@@ -0,0 +1,400 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "resourceids.h"
+
+// every notification the news can send, in one constexpr table.
+// the cli flags, the gui buttons and the auto toast all look stuff up here
+// instead of comparing strings all day
+
+enum class NotificationId : std::uint8_t {
+    SomeoneDied,
+    Donate,
+    ServersDying,
+    DeleteSystem32,
+    IncomingCall,
+    EarthOnFire,
+    FriendRequest,
+    WebsiteRedesign,
+    Roadblocks,
+    LinkerTragedy,
+    MazeGambled,
+    FemboyLabs,
+    BussinIndustries,
+    HTile,
+    BaseballEmoji,
+    JonathanPork,
+    LinkerAgain,
+    HGif,
+    FindMeOnline,
+    GoogServices,
+    Flash,
+    Mcafee,
+    Noskid,
+    Count
+};
+
+constexpr std::size_t notificationCount = static_cast<std::size_t>(NotificationId::Count);
+
+// same values as NotifyUrgency so we dont need libnotify in here
+enum class NotificationUrgency : std::uint8_t {
+    Low,
+    Normal,
+    Critical
+};
+
+struct NotificationAction {
+    const char *id;
+    const char *label;
+};
+
+constexpr std::size_t maxNotificationActions = 3;
+
+struct NotificationDescriptor {
+    NotificationId id;
+    std::string_view key;   // also the cli flag without the --
+    const char *title;
+    const char *body;
+    NotificationUrgency urgency;
+    const char *category;   // "category" hint, nullptr if none
+    ResourceId image;       // ResourceId::None if none
+    std::array<NotificationAction, maxNotificationActions> actions;
+    std::size_t actionCount;
+    int progress;           // "value" hint, -1 if none
+    const char *synchronous; // "synchronous" hint, nullptr if none
+    bool deploysH;          // drops the h desktop file before showing
+    const char *help;
+};
+
+namespace catalog_detail {
+
+constexpr NotificationAction noAction{nullptr, nullptr};
+constexpr NotificationAction readMore{"read_more", "Read More"};
+constexpr NotificationAction discard{"discard", "discard"};
+constexpr NotificationAction donate100k{"donate_100k", "100k dollars"};
+constexpr NotificationAction donate1k{"donate_1k", "1k dollars"};
+constexpr NotificationAction donate1{"donate_1", "1 dollar"};
+constexpr NotificationAction answer{"answer", "Answer"};
+
+} // namespace catalog_detail
+
+constexpr std::array<NotificationDescriptor, notificationCount> notificationCatalog = {{
+    {NotificationId::SomeoneDied, "someoneDied",
+        "BREAKING NEWS!!!",
+        "Someone just died! Who? We don't know.",
+        NotificationUrgency::Normal, nullptr, ResourceId::None,
+        {catalog_detail::noAction, catalog_detail::noAction, catalog_detail::noAction}, 0,
+        -1, nullptr, false, "someone died notification"},
+
+    {NotificationId::Donate, "donate",
+        "we need your money",
+        "donate to \"the news\"\n\n",
+        NotificationUrgency::Normal, nullptr, ResourceId::None,
+        {catalog_detail::donate100k, catalog_detail::donate1k, catalog_detail::donate1}, 3,
+        -1, nullptr, false, "donation request"},
+
+    {NotificationId::ServersDying, "serversDying",
+        "please donate us money",
+        "our in house servers ae dying of money :(\n\n",
+        NotificationUrgency::Critical, nullptr, ResourceId::None,
+        {catalog_detail::donate100k, catalog_detail::donate1k, catalog_detail::donate1}, 3,
+        -1, nullptr, false, "servers dying notification"},
+
+    {NotificationId::DeleteSystem32, "deleteSystem32",
+        "welp",
+        "since you didn't donate to the news...\ndeleting system32...\n21/15,245 files",
+        NotificationUrgency::Normal, nullptr, ResourceId::None,
+        {NotificationAction{"cope", "cope ¯\\_(\\ツ)_/¯"}, NotificationAction{"donate_late", "donate before its late"}, catalog_detail::noAction}, 2,
+        50, "system32-delete", false, "system32 deletion warning"},
+
+    {NotificationId::IncomingCall, "incomingCall",
+        "John Phone",
+        "Incoming Call - Satellite",
+        NotificationUrgency::Critical, "im.received", ResourceId::JohnphoneJpg,
+        {catalog_detail::answer, catalog_detail::noAction, catalog_detail::noAction}, 1,
+        -1, nullptr, false, "John Phone incoming call"},
+
+    {NotificationId::EarthOnFire, "earthOnFire",
+        "BREAKING NEWS! the earth is on fire lmfao",
+        "weather forecast:\n\n"
+        "Mon: ☀️ 63° / 42°\n"
+        "Tue: ☀️ 78° / 60°\n"
+        "Wed: ☀️ 96° / 76°\n"
+        "Thu: ☀️ 132° / 89°\n"
+        "Fri: ☀️ 244° / 120°",
+        NotificationUrgency::Normal, nullptr, ResourceId::None,
+        {catalog_detail::noAction, catalog_detail::noAction, catalog_detail::noAction}, 0,
+        -1, nullptr, false, "earth on fire weather forecast"},
+
+    {NotificationId::FriendRequest, "friendRequest",
+        "John Phone sent you a friend request",
+        "i want Sponsorships.",
+        NotificationUrgency::Normal, nullptr, ResourceId::JohnphoneJpg,
+        {NotificationAction{"accept", "Accept"}, NotificationAction{"decline", "Decline"}, catalog_detail::noAction}, 2,
+        -1, nullptr, false, "John Phone friend request"},
+
+    {NotificationId::WebsiteRedesign, "websiteRedesign",
+        "we redesigned our website",
+        "enjoy it and leave feed back",
+        NotificationUrgency::Normal, nullptr, ResourceId::RedesignPng,
+        {NotificationAction{"good", "good"}, NotificationAction{"horrid", "horrid"}, catalog_detail::noAction}, 2,
+        -1, nullptr, false, "website redesign announcement"},
+
+    {NotificationId::Roadblocks, "roadblocks",
+        "BREAKING NEWS!!!",
+        "California man posts TikTok of him riding in his golf cart rambling on about 'roadblocks' on the beach, goes crazy fucking viral.",
+        // roadblocks.gif never made it into the repo, the roadblock man from page 1 fills in
+        NotificationUrgency::Normal, nullptr, ResourceId::RoadblockmanPng,
+        {catalog_detail::readMore, catalog_detail::discard, catalog_detail::noAction}, 2,
+        -1, nullptr, false, "roadblocks viral video"},
+
+    {NotificationId::LinkerTragedy, "linkerTragedy",
+        "BREAKING NEWS!!!",
+        "Discord user @linker.sh, from the server 'Face's attic', goes all in on black, loses it all in 1 night - tragedy unfolds.",
+        NotificationUrgency::Normal, nullptr, ResourceId::LinkerShPng,
+        {catalog_detail::readMore, catalog_detail::discard, catalog_detail::noAction}, 2,
+        -1, nullptr, false, "linker gambling tragedy"},
+
+    {NotificationId::MazeGambled, "mazeGambled",
+        "BREAKING NEWS!!!!!!!!!!!!!!!!!!!!!",
+        "MAZE CONCENTRATED ON GAMBLING SO HARD THEY GOT $-1 IN RETURN???",
+        NotificationUrgency::Normal, nullptr, ResourceId::MazePng,
+        {catalog_detail::readMore, catalog_detail::discard, catalog_detail::noAction}, 2,
+        -1, nullptr, false, "maze gambling story"},
+
+    {NotificationId::FemboyLabs, "femboyLabs",
+        "BREAKING NEWS!!!",
+        "femboyLabs has rebranded again!",
+        NotificationUrgency::Normal, nullptr, ResourceId::AstolfoJpg,
+        {catalog_detail::readMore, catalog_detail::discard, catalog_detail::noAction}, 2,
+        -1, nullptr, false, "femboyLabs rebrand"},
+
+    {NotificationId::BussinIndustries, "bussinIndustries",
+        "BREAKING NEWS!!!",
+        "Bussin Industries shares cryptic note on staff channels.\n\nSource: X",
+        NotificationUrgency::Normal, nullptr, ResourceId::BussinIndustriesPng,
+        {catalog_detail::readMore, catalog_detail::discard, catalog_detail::noAction}, 2,
+        -1, nullptr, false, "Bussin Industries cryptic note"},
+
+    {NotificationId::HTile, "hTile",
+        "h",
+        "check your start menu and enjoy your free h",
+        NotificationUrgency::Normal, nullptr, ResourceId::HGif,
+        {catalog_detail::noAction, catalog_detail::noAction, catalog_detail::noAction}, 0,
+        -1, nullptr, true, "put the h in your start menu"},
+
+    {NotificationId::BaseballEmoji, "baseballEmoji",
+        "⚾️ Baseball on Discord?! 🤯",
+        "Fr fr, a baseball emoji just dropped on Discord. Icl, ts kinda mogging ngl. 🤣",
+        NotificationUrgency::Normal, nullptr, ResourceId::WhateverthisisPng,
+        {catalog_detail::readMore, catalog_detail::discard, catalog_detail::noAction}, 2,
+        -1, nullptr, false, "baseball emoji on Discord"},
+
+    {NotificationId::JonathanPork, "jonathanPork",
+        "John Pork",
+        "Incoming Call - Satellite",
+        NotificationUrgency::Critical, "im.received", ResourceId::JohnporkJpg,
+        {catalog_detail::answer, catalog_detail::noAction, catalog_detail::noAction}, 1,
+        -1, nullptr, false, "john Pork incoming call"},
+
+    {NotificationId::LinkerAgain, "linkerAgain",
+        "Text message from +1 248-434-5508",
+        "We've successfully assassinated the attacker. Thank you for contacting Valve Support.\n\nLinker's Samsung Galaxy",
+        NotificationUrgency::Normal, nullptr, ResourceId::None,
+        {NotificationAction{"gamble", "Gamble it all away"}, catalog_detail::noAction, catalog_detail::noAction}, 1,
+        -1, nullptr, false, "linker text message"},
+
+    {NotificationId::HGif, "hGif",
+        "h",
+        "h",
+        NotificationUrgency::Normal, nullptr, ResourceId::HGif,
+        {catalog_detail::noAction, catalog_detail::noAction, catalog_detail::noAction}, 0,
+        -1, nullptr, false, "h gif notification"},
+
+    {NotificationId::FindMeOnline, "findMeOnline",
+        "John Phone",
+        "Find me online",
+        NotificationUrgency::Normal, nullptr, ResourceId::ItsmeJohnphoneJpg,
+        {NotificationAction{"send", "Send"}, catalog_detail::noAction, catalog_detail::noAction}, 1,
+        -1, nullptr, false, "find me online"},
+
+    {NotificationId::GoogServices, "googServices",
+        "the news needs Google Play Services",
+        "the news uses Google Play Services to provide you a better experience. Install it. Right now. I don't care that you are using a desktop OS. Install it.",
+        NotificationUrgency::Normal, nullptr, ResourceId::GoogleplayservicesPng,
+        {catalog_detail::noAction, catalog_detail::noAction, catalog_detail::noAction}, 0,
+        -1, nullptr, false, "Google Play Services request"},
+
+    {NotificationId::Flash, "flash",
+        "BREAKING NEWS!!!",
+        "To view this notification, install Adobe® Flash Player™",
+        NotificationUrgency::Normal, nullptr, ResourceId::FlashplayerPng,
+        {catalog_detail::noAction, catalog_detail::noAction, catalog_detail::noAction}, 0,
+        -1, nullptr, false, "Flash Player required"},
+
+    {NotificationId::Mcafee, "mcafee",
+        "BREAKING NEWS!!!",
+        "Your McAfee™ subscription plan has expired. Please select a new one below.\n\nEssential - $119.99\nMcAfee+™ Premium Individual - $149.99\nMcAfee+™ Advanced Individual - $199.99",
+        NotificationUrgency::Normal, nullptr, ResourceId::McafeePng,
+        {NotificationAction{"subscribe", "yeah this gud!"}, NotificationAction{"cancel", "no never cancel it rn"}, catalog_detail::noAction}, 2,
+        -1, nullptr, false, "McAfee subscription expired"},
+
+    {NotificationId::Noskid, "noskid",
+        "BREAKING NEWS!!!",
+        "To view this notification, upload a NoSkid certificate.",
+        NotificationUrgency::Normal, nullptr, ResourceId::NoskidPng,
+        {catalog_detail::noAction, catalog_detail::noAction, catalog_detail::noAction}, 0,
+        -1, nullptr, false, "NoSkid certificate required"},
+}};
+
+// what you get when you ask for something that isnt in the catalog
+constexpr NotificationDescriptor unknownNotification = {
+    NotificationId::Count, "",
+    "no notification :(",
+    "notification doesnt exist somehow what did i call to get this...?",
+    NotificationUrgency::Normal, nullptr, ResourceId::None,
+    {catalog_detail::noAction, catalog_detail::noAction, catalog_detail::noAction}, 0,
+    -1, nullptr, false, ""
+};
+
+// the auto toast cycles through these
+constexpr std::array<NotificationId, 10> autoToastRotation = {
+    NotificationId::SomeoneDied,
+    NotificationId::Donate,
+    NotificationId::ServersDying,
+    NotificationId::DeleteSystem32,
+    NotificationId::IncomingCall,
+    NotificationId::EarthOnFire,
+    NotificationId::FriendRequest,
+    NotificationId::WebsiteRedesign,
+    NotificationId::Roadblocks,
+    NotificationId::LinkerTragedy,
+};
+
+struct NotificationAlias {
+    std::string_view key;
+    NotificationId id;
+};
+
+// extra names that arent a catalog key
+constexpr std::array<NotificationAlias, 1> notificationAliases = {{
+    {"h", NotificationId::HGif},
+}};
+
+namespace catalog_detail {
+
+constexpr bool catalogIsInEnumOrder() {
+    for (std::size_t i = 0; i < notificationCatalog.size(); i++) {
+        if (static_cast<std::size_t>(notificationCatalog[i].id) != i) {
+            return false;
+        }
+        if (notificationCatalog[i].actionCount > maxNotificationActions) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(catalogIsInEnumOrder(), "notificationCatalog has to be in NotificationId order");
+
+constexpr std::uint32_t hashKey(std::string_view key, std::uint32_t seed) {
+    // fnv-1a with a seed mixed in
+    std::uint32_t hash = 2166136261u ^ seed;
+    for (char c : key) {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 15;
+    return hash;
+}
+
+constexpr std::size_t lookupSlots = 128;
+constexpr std::uint8_t emptySlot = 0xff;
+constexpr std::size_t lookupKeyCount = notificationCount + notificationAliases.size();
+
+constexpr std::string_view lookupKey(std::size_t i) {
+    return i < notificationCount ? notificationCatalog[i].key : notificationAliases[i - notificationCount].key;
+}
+
+constexpr NotificationId lookupId(std::size_t i) {
+    return i < notificationCount ? notificationCatalog[i].id : notificationAliases[i - notificationCount].id;
+}
+
+// find a seed where no two keys land in the same slot, so a lookup is one
+// hash and one compare
+constexpr std::uint32_t findPerfectSeed() {
+    for (std::uint32_t seed = 0; seed < 65536; seed++) {
+        std::array<bool, lookupSlots> used{};
+        bool collision = false;
+        for (std::size_t i = 0; i < lookupKeyCount && !collision; i++) {
+            std::size_t slot = hashKey(lookupKey(i), seed) & (lookupSlots - 1);
+            collision = used[slot];
+            used[slot] = true;
+        }
+        if (!collision) {
+            return seed;
+        }
+    }
+    return 0xffffffffu;
+}
+
+constexpr std::uint32_t perfectSeed = findPerfectSeed();
+static_assert(perfectSeed != 0xffffffffu, "couldnt find a perfect hash seed, bump lookupSlots");
+
+struct LookupSlot {
+    std::uint8_t key;  // index into lookupKey(), emptySlot if unused
+    std::uint8_t id;
+};
+
+constexpr std::array<LookupSlot, lookupSlots> buildLookupTable() {
+    std::array<LookupSlot, lookupSlots> table{};
+    for (auto &slot : table) {
+        slot = {emptySlot, emptySlot};
+    }
+    for (std::size_t i = 0; i < lookupKeyCount; i++) {
+        std::size_t slot = hashKey(lookupKey(i), perfectSeed) & (lookupSlots - 1);
+        table[slot] = {static_cast<std::uint8_t>(i), static_cast<std::uint8_t>(lookupId(i))};
+    }
+    return table;
+}
+
+constexpr std::array<LookupSlot, lookupSlots> lookupTable = buildLookupTable();
+
+} // namespace catalog_detail
+
+constexpr const NotificationDescriptor &notificationDescriptor(NotificationId id) {
+    return static_cast<std::size_t>(id) < notificationCount
+        ? notificationCatalog[static_cast<std::size_t>(id)]
+        : unknownNotification;
+}
+
+// key -> id, returns false for stuff that isnt in the catalog
+constexpr bool findNotification(std::string_view key, NotificationId &out) {
+    const auto &slot = catalog_detail::lookupTable[catalog_detail::hashKey(key, catalog_detail::perfectSeed) & (catalog_detail::lookupSlots - 1)];
+    if (slot.key == catalog_detail::emptySlot || catalog_detail::lookupKey(slot.key) != key) {
+        return false;
+    }
+    out = static_cast<NotificationId>(slot.id);
+    return true;
+}
+
+namespace catalog_detail {
+
+constexpr bool everyKeyResolves() {
+    for (std::size_t i = 0; i < lookupKeyCount; i++) {
+        NotificationId id = NotificationId::Count;
+        if (!findNotification(lookupKey(i), id) || id != lookupId(i)) {
+            return false;
+        }
+    }
+    NotificationId id = NotificationId::Count;
+    return !findNotification("nope", id) && !findNotification("", id);
+}
+
+static_assert(everyKeyResolves(), "catalog lookup table is broken");
+
+} // namespace catalog_detail
@@ -0,0 +1,93 @@
+# cmake -P step that keeps resources.qrc honest and turns it into resourceids.h
+#
+#   -DQRC=resources.qrc            the qrc to read
+#   -DSOURCES=a.cpp|pages/b.ui     files that mention ":/..." paths, | separated
+#   -DOUTPUT=resourceids.h         the header to write
+#
+# the build fails if the qrc lists a file that isnt there, or if a source
+# mentions a resource the qrc doesnt have. the header gives every resource a
+# ResourceId so the code can say ResourceId::AstolfoJpg instead of a string
+
+cmake_policy(SET CMP0057 NEW) # if(IN_LIST)
+
+get_filename_component(QRC "${QRC}" ABSOLUTE)
+get_filename_component(QRC_DIR "${QRC}" DIRECTORY)
+file(READ "${QRC}" QRC_CONTENTS)
+string(REGEX MATCHALL "<file>[^<]+</file>" QRC_ENTRIES "${QRC_CONTENTS}")
+
+set(ERRORS "")
+set(RESOURCE_PATHS "")
+set(RESOURCE_NAMES "")
+foreach(ENTRY ${QRC_ENTRIES})
+    string(REGEX REPLACE "<file>([^<]+)</file>" "\\1" FILE_NAME "${ENTRY}")
+    if(NOT EXISTS "${QRC_DIR}/${FILE_NAME}")
+        string(APPEND ERRORS "  resources.qrc lists ${FILE_NAME} but it doesnt exist\n")
+    endif()
+    list(APPEND RESOURCE_PATHS ":/${FILE_NAME}")
+
+    # assets/itsme...johnphone.jpg -> ItsmeJohnphoneJpg
+    get_filename_component(BASE_NAME "${FILE_NAME}" NAME)
+    string(REGEX MATCHALL "[A-Za-z0-9]+" PARTS "${BASE_NAME}")
+    set(ID "")
+    foreach(PART ${PARTS})
+        string(SUBSTRING "${PART}" 0 1 FIRST)
+        string(SUBSTRING "${PART}" 1 -1 REST)
+        string(TOUPPER "${FIRST}" FIRST)
+        string(APPEND ID "${FIRST}${REST}")
+    endforeach()
+    if(ID MATCHES "^[0-9]")
+        set(ID "R${ID}")
+    endif()
+    if(ID IN_LIST RESOURCE_NAMES)
+        string(APPEND ERRORS "  ${FILE_NAME} would be ResourceId::${ID} and thats taken, rename one\n")
+    endif()
+    list(APPEND RESOURCE_NAMES "${ID}")
+endforeach()
+
+string(REPLACE "|" ";" SOURCE_LIST "${SOURCES}")
+foreach(SOURCE ${SOURCE_LIST})
+    file(READ "${SOURCE}" SOURCE_CONTENTS)
+    # only ones that start a literal: "..." in code or a stylesheet, url(...),
+    # <iconset>... in a .ui. a url like http://x in a help string or a comment
+    # isnt a resource. .ui files escape their quotes, and the ; in &quot; would
+    # split the match list anyway
+    string(REPLACE "&quot;" "\"" SOURCE_CONTENTS "${SOURCE_CONTENTS}")
+    string(REGEX MATCHALL "[\"(>]:/[A-Za-z0-9_./-]+" REFERENCES "${SOURCE_CONTENTS}")
+    foreach(REFERENCE ${REFERENCES})
+        string(SUBSTRING "${REFERENCE}" 1 -1 REFERENCE)
+        if(NOT REFERENCE IN_LIST RESOURCE_PATHS)
+            get_filename_component(SOURCE_NAME "${SOURCE}" NAME)
+            string(APPEND ERRORS "  ${SOURCE_NAME} uses ${REFERENCE} but resources.qrc doesnt have it\n")
+        endif()
+    endforeach()
+endforeach()
+
+if(ERRORS)
+    message(FATAL_ERROR "broken resource references:\n${ERRORS}")
+endif()
+
+list(LENGTH RESOURCE_PATHS COUNT)
+set(HEADER "// generated from resources.qrc by cmake/check_resources.cmake, dont edit\n\n")
+string(APPEND HEADER "#pragma once\n\n#include <array>\n#include <cstddef>\n#include <cstdint>\n\n")
+string(APPEND HEADER "enum class ResourceId : std::uint8_t {\n")
+foreach(ID ${RESOURCE_NAMES})
+    string(APPEND HEADER "    ${ID},\n")
+endforeach()
+string(APPEND HEADER "    Count,\n    None = 0xff\n};\n\n")
+string(APPEND HEADER "constexpr std::size_t resourceCount = ${COUNT};\n\n")
+string(APPEND HEADER "constexpr std::array<const char *, resourceCount> resourcePaths = {{\n")
+foreach(RESOURCE_PATH ${RESOURCE_PATHS})
+    string(APPEND HEADER "    \"${RESOURCE_PATH}\",\n")
+endforeach()
+string(APPEND HEADER "}};\n\n")
+string(APPEND HEADER "// the qrc path, nullptr for ResourceId::None\n")
+string(APPEND HEADER "constexpr const char *resourcePath(ResourceId id) {\n")
+string(APPEND HEADER "    return id == ResourceId::None ? nullptr : resourcePaths[static_cast<std::size_t>(id)];\n}\n")
+
+# only touch it when it changes so everything including it doesnt rebuild
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" OLD_HEADER)
+endif()
+if(NOT OLD_HEADER STREQUAL HEADER)
+    file(WRITE "${OUTPUT}" "${HEADER}")
+endif()
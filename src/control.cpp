@@ -0,0 +1,102 @@
+#include "control.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+std::string defaultControlSocketPath() {
+    const char *runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir && *runtimeDir) {
+        return std::string(runtimeDir) + "/thenews.sock";
+    }
+    return "/tmp/thenews-" + std::to_string(getuid()) + ".sock";
+}
+
+bool sendToDaemon(const std::string &socketPath, const std::vector<std::string> &ids, std::string &error) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        error = "socket path is too long: " + socketPath;
+        return false;
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = std::string("couldnt make a socket: ") + std::strerror(errno);
+        return false;
+    }
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        error = "is the daemon running? couldnt connect to " + socketPath + ": " + std::strerror(errno);
+        close(fd);
+        return false;
+    }
+
+    std::string request;
+    for (const auto &id : ids) {
+        request += "send ";
+        request += id;
+        request += '\n';
+    }
+
+    std::size_t written = 0;
+    while (written < request.size()) {
+        ssize_t n = send(fd, request.data() + written, request.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            error = std::string("daemon hung up on us: ") + std::strerror(errno);
+            close(fd);
+            return false;
+        }
+        written += static_cast<std::size_t>(n);
+    }
+
+    // one reply line per id
+    std::string replies;
+    std::size_t lines = 0;
+    char buffer[4096];
+    while (lines < ids.size()) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            if (buffer[i] == '\n') {
+                lines++;
+            }
+        }
+        replies.append(buffer, static_cast<std::size_t>(n));
+    }
+    close(fd);
+
+    if (lines < ids.size()) {
+        error = "daemon hung up before answering everything";
+        return false;
+    }
+
+    bool ok = true;
+    std::string_view rest = replies;
+    for (std::size_t i = 0; i < ids.size(); i++) {
+        std::size_t end = rest.find('\n');
+        std::string_view reply = rest.substr(0, end);
+        rest.remove_prefix(end + 1);
+        if (reply != "ok") {
+            if (!error.empty()) {
+                error += "\n";
+            }
+            error += ids[i] + ": " + std::string(reply);
+            ok = false;
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// the control socket that thenews --daemon listens on, and the client side
+// used by thenews --send. the client is plain posix so sending a toast to a
+// running daemon doesnt have to start qt, glib or libnotify
+//
+// the protocol is one command per line, one reply line per command:
+//   send <id>   queue a notification      -> "ok" or "error <why>"
+//   ping                                  -> "pong"
+//   stats       dispatch and cache counts -> "ok key=value ..."
+
+// $XDG_RUNTIME_DIR/thenews.sock, or /tmp/thenews-<uid>.sock without one
+std::string defaultControlSocketPath();
+
+// connects to the daemon and sends every id over the one connection. false if
+// the daemon couldnt be reached or rejected any of them, error says why
+bool sendToDaemon(const std::string &socketPath, const std::vector<std::string> &ids, std::string &error);
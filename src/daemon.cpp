@@ -0,0 +1,269 @@
+#include "daemon.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "catalog.h"
+#include "imagecache.h"
+#include "notifications.h"
+
+#include <QCoreApplication>
+#include <QSocketNotifier>
+
+namespace {
+
+int signalPipe[2] = {-1, -1};
+
+void onSignal(int) {
+    char byte = 0;
+    // nothing useful to do if this fails, we just dont quit nicely
+    [[maybe_unused]] ssize_t n = write(signalPipe[1], &byte, 1);
+}
+
+class ControlServer {
+public:
+    explicit ControlServer(NotificationDispatcher &dispatcher) : m_dispatcher(dispatcher) {}
+
+    ~ControlServer() {
+        for (auto &client : m_clients) {
+            delete client.second.notifier;
+            close(client.first);
+        }
+        delete m_listenNotifier;
+        if (m_listenFd >= 0) {
+            close(m_listenFd);
+            unlink(m_path.c_str());
+        }
+    }
+
+    bool listen(const std::string &path, std::string &error) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            error = "socket path is too long: " + path;
+            return false;
+        }
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+        m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_listenFd < 0) {
+            error = std::string("couldnt make a socket: ") + std::strerror(errno);
+            return false;
+        }
+
+        int bound = bind(m_listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        if (bound < 0 && errno == EADDRINUSE) {
+            // left over from a daemon that died? only take it over if nobody answers
+            int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            bool alive = probe >= 0 && connect(probe, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+            if (probe >= 0) {
+                close(probe);
+            }
+            if (alive) {
+                error = "theres already a daemon listening on " + path;
+                close(m_listenFd);
+                m_listenFd = -1;
+                return false;
+            }
+            unlink(path.c_str());
+            bound = bind(m_listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        }
+        if (bound < 0 || ::listen(m_listenFd, 64) < 0) {
+            error = "couldnt listen on " + path + ": " + std::strerror(errno);
+            close(m_listenFd);
+            m_listenFd = -1;
+            return false;
+        }
+        m_path = path;
+
+        m_listenNotifier = new QSocketNotifier(m_listenFd, QSocketNotifier::Read);
+        QObject::connect(m_listenNotifier, &QSocketNotifier::activated, [this]() {
+            acceptClients();
+        });
+        return true;
+    }
+
+private:
+    struct Client {
+        QSocketNotifier *notifier;
+        std::string buffer;
+    };
+
+    void acceptClients() {
+        while (true) {
+            int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;
+            }
+            QSocketNotifier *notifier = new QSocketNotifier(fd, QSocketNotifier::Read);
+            QObject::connect(notifier, &QSocketNotifier::activated, [this, fd]() {
+                readClient(fd);
+            });
+            m_clients.emplace(fd, Client{notifier, std::string()});
+        }
+    }
+
+    void readClient(int fd) {
+        auto it = m_clients.find(fd);
+        if (it == m_clients.end()) {
+            return;
+        }
+        Client &client = it->second;
+
+        char buffer[4096];
+        while (true) {
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                client.buffer.append(buffer, static_cast<std::size_t>(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            // eof or a real error, answer whatever full lines we got and hang up
+            reply(fd, client.buffer);
+            closeClient(fd);
+            return;
+        }
+
+        if (!reply(fd, client.buffer)) {
+            closeClient(fd);
+        }
+    }
+
+    // answers every complete line in buffer and removes it from there
+    bool reply(int fd, std::string &buffer) {
+        std::string replies;
+        std::size_t start = 0;
+        std::size_t end;
+        while ((end = buffer.find('\n', start)) != std::string::npos) {
+            replies += handle(std::string_view(buffer).substr(start, end - start));
+            replies += '\n';
+            start = end + 1;
+        }
+        buffer.erase(0, start);
+
+        if (buffer.size() > 4096) {
+            // nobody sends lines this long on purpose
+            return false;
+        }
+
+        std::size_t written = 0;
+        while (written < replies.size()) {
+            ssize_t n = send(fd, replies.data() + written, replies.size() - written, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                // the replies are tiny, a client that cant take them isnt reading
+                return false;
+            }
+            written += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    std::string handle(std::string_view line) {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        if (line.substr(0, 5) == "send ") {
+            std::string_view key = line.substr(5);
+            if (key.substr(0, 2) == "--") {
+                key.remove_prefix(2);
+            }
+            NotificationId id;
+            if (!findNotification(key, id)) {
+                return "error no notification called " + std::string(key);
+            }
+            return m_dispatcher.enqueue(id) ? "ok" : "error not queued";
+        }
+        if (line == "ping") {
+            return "pong";
+        }
+        if (line == "stats") {
+            DispatchStats dispatch = m_dispatcher.stats();
+            ImageCacheStats cache = ImageCache::instance().stats();
+            NotificationPoolStats pool = notificationPoolStats();
+            return "ok queued=" + std::to_string(dispatch.queued) +
+                " sent=" + std::to_string(dispatch.sent) +
+                " failed=" + std::to_string(dispatch.failed) +
+                " dropped=" + std::to_string(dispatch.dropped) +
+                " coalesced=" + std::to_string(dispatch.coalesced) +
+                " depth=" + std::to_string(dispatch.depth) +
+                " cache_hits=" + std::to_string(cache.hits) +
+                " cache_misses=" + std::to_string(cache.misses) +
+                " cache_bytes=" + std::to_string(cache.bytes) +
+                " pool_size=" + std::to_string(pool.pooled) +
+                " pool_built=" + std::to_string(pool.created) +
+                " pool_reused=" + std::to_string(pool.reused);
+        }
+        return "error unknown command";
+    }
+
+    void closeClient(int fd) {
+        auto it = m_clients.find(fd);
+        if (it == m_clients.end()) {
+            return;
+        }
+        // we might be inside this notifier's activated signal right now
+        it->second.notifier->setEnabled(false);
+        it->second.notifier->deleteLater();
+        m_clients.erase(it);
+        close(fd);
+    }
+
+    NotificationDispatcher &m_dispatcher;
+    int m_listenFd = -1;
+    std::string m_path;
+    QSocketNotifier *m_listenNotifier = nullptr;
+    std::unordered_map<int, Client> m_clients;
+};
+
+} // namespace
+
+int runDaemon(int argc, char *argv[], const std::string &socketPath, DispatchPolicy policy, std::size_t queueSize) {
+    QCoreApplication app(argc, argv);
+
+    NotificationDispatcher dispatcher(queueSize, policy);
+    dispatcher.setCallback(&app, [](const DispatchResult &result) {
+        if (!result.ok) {
+            std::cerr << result.error << "\n";
+        }
+    });
+
+    ControlServer server(dispatcher);
+    std::string error;
+    if (!server.listen(socketPath, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    // decode everything now so the first toast of each kind is as fast as the rest
+    preloadNotificationImages();
+
+    // ctrl+c and kill go through a pipe so we can quit from the event loop
+    // and clean up the socket file
+    if (pipe2(signalPipe, O_CLOEXEC | O_NONBLOCK) == 0) {
+        QSocketNotifier *signalNotifier = new QSocketNotifier(signalPipe[0], QSocketNotifier::Read, &app);
+        QObject::connect(signalNotifier, &QSocketNotifier::activated, &app, &QCoreApplication::quit);
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+    }
+
+    std::cout << "the news daemon is listening on " << socketPath << "\n";
+    return app.exec();
+}
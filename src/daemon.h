@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "dispatcher.h"
+
+// thenews --daemon: stays resident with libnotify set up and every
+// notification image already decoded, and queues toasts that come in on the
+// control socket (see control.h). returns the exit code
+int runDaemon(int argc, char *argv[], const std::string &socketPath, DispatchPolicy policy, std::size_t queueSize);
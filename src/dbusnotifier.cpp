@@ -0,0 +1,286 @@
+#include "dbusnotifier.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <unistd.h>
+
+#include "metrics.h"
+#include "notificationevents.h"
+#include "notifications.h"
+
+// a Notify on its way, owned by whoever has it at the moment: send() hands it
+// to issue() on our thread, issue() hands it to gdbus until the reply
+struct DBusNotifier::Call {
+    DBusNotifier *self;
+    NotificationId id;
+    GVariant *arguments;
+    std::chrono::steady_clock::time_point prepareStart;
+    std::chrono::steady_clock::time_point issued;
+};
+
+DBusNotifier &DBusNotifier::instance() {
+    static DBusNotifier notifier;
+    return notifier;
+}
+
+DBusNotifier::~DBusNotifier() {
+    if (m_thread.joinable()) {
+        g_main_context_invoke(m_context, &DBusNotifier::quit, m_loop);
+        m_thread.join();
+        g_main_loop_unref(m_loop);
+        g_main_context_unref(m_context);
+    }
+    if (m_connection) {
+        g_dbus_connection_signal_unsubscribe(m_connection, m_signalSubscription);
+        g_object_unref(m_connection);
+    }
+    clear();
+}
+
+void DBusNotifier::setWindow(std::size_t window) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_window = window > 0 ? window : 1;
+    }
+    m_changed.notify_all();
+}
+
+std::size_t DBusNotifier::window() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_window;
+}
+
+bool DBusNotifier::connect(std::string *error) {
+    std::lock_guard<std::mutex> lock(m_connectMutex);
+    if (m_connection) {
+        return true;
+    }
+
+    GError *busError = nullptr;
+    GDBusConnection *connection = g_bus_get_sync(G_BUS_TYPE_SESSION, nullptr, &busError);
+    if (!connection) {
+        if (error) {
+            *error = std::string("no session bus for the gdbus backend: ") + (busError ? busError->message : "no idea why");
+        }
+        g_clear_error(&busError);
+        return false;
+    }
+
+    m_connection = connection;
+    m_context = g_main_context_new();
+    m_loop = g_main_loop_new(m_context, FALSE);
+    m_thread = std::thread(&DBusNotifier::run, this);
+    return true;
+}
+
+void DBusNotifier::run() {
+    g_main_context_push_thread_default(m_context);
+    // libnotify prints "ok" when someone clicks an action on one of its toasts,
+    // so do we. the server sends these to everyone, so only the server counts
+    // and only for ids it gave us. signals land in the context thats the
+    // thread default when subscribing, ours
+    m_signalSubscription = g_dbus_connection_signal_subscribe(
+        m_connection, "org.freedesktop.Notifications", "org.freedesktop.Notifications", nullptr,
+        "/org/freedesktop/Notifications", nullptr, G_DBUS_SIGNAL_FLAGS_NONE, &DBusNotifier::onSignal, this, nullptr);
+    g_main_loop_run(m_loop);
+    g_main_context_pop_thread_default(m_context);
+}
+
+gboolean DBusNotifier::quit(gpointer loop) {
+    g_main_loop_quit(static_cast<GMainLoop *>(loop));
+    return G_SOURCE_REMOVE;
+}
+
+void DBusNotifier::onSignal(GDBusConnection *, const gchar *, const gchar *, const gchar *, const gchar *signal,
+                            GVariant *parameters, gpointer self) {
+    auto &shown = static_cast<DBusNotifier *>(self)->m_shown;
+    guint32 serverId = 0;
+    if (g_strcmp0(signal, "ActionInvoked") == 0 && g_variant_is_of_type(parameters, G_VARIANT_TYPE("(us)"))) {
+        g_variant_get(parameters, "(u&s)", &serverId, nullptr);
+        if (shown.count(serverId)) {
+            std::cout << "ok\n";
+        }
+    } else if (g_strcmp0(signal, "NotificationClosed") == 0 && g_variant_is_of_type(parameters, G_VARIANT_TYPE("(uu)"))) {
+        g_variant_get(parameters, "(uu)", &serverId, nullptr);
+        shown.erase(serverId);
+    }
+}
+
+// everything Notify takes, the way libnotify would send it
+static GVariant *buildArguments(const NotificationDescriptor &desc) {
+    GVariantBuilder actions;
+    g_variant_builder_init(&actions, G_VARIANT_TYPE("as"));
+    for (std::size_t i = 0; i < desc.actionCount; i++) {
+        g_variant_builder_add(&actions, "s", desc.actions[i].id);
+        g_variant_builder_add(&actions, "s", desc.actions[i].label);
+    }
+
+    GVariantBuilder hints;
+    g_variant_builder_init(&hints, G_VARIANT_TYPE("a{sv}"));
+    if (desc.image != ResourceId::None) {
+        const char *key = nullptr;
+        GVariant *image = notificationImageHint(desc.image, key);
+        if (image) {
+            g_variant_builder_add(&hints, "{sv}", key, image);
+            g_variant_unref(image);
+        }
+    }
+    if (desc.urgency != NotificationUrgency::Normal) {
+        g_variant_builder_add(&hints, "{sv}", "urgency", g_variant_new_byte(static_cast<guchar>(desc.urgency)));
+    }
+    if (desc.category) {
+        g_variant_builder_add(&hints, "{sv}", "category", g_variant_new_string(desc.category));
+    }
+    if (desc.progress >= 0) {
+        g_variant_builder_add(&hints, "{sv}", "value", g_variant_new_int32(desc.progress));
+    }
+    if (desc.synchronous) {
+        g_variant_builder_add(&hints, "{sv}", "synchronous", g_variant_new_string(desc.synchronous));
+    }
+    g_variant_builder_add(&hints, "{sv}", "sender-pid", g_variant_new_int64(getpid()));
+
+    GVariant *arguments = g_variant_new("(susssasa{sv}i)", "the news", 0u, "", desc.title, desc.body ? desc.body : "",
+                                        &actions, &hints, -1);
+    return g_variant_ref_sink(arguments);
+}
+
+GVariant *DBusNotifier::arguments(const NotificationDescriptor &desc) {
+    std::size_t index = static_cast<std::size_t>(desc.id);
+    if (index >= notificationCount) {
+        return buildArguments(desc);
+    }
+
+    GVariant *arguments;
+    {
+        std::lock_guard<std::mutex> lock(m_argumentsMutex);
+        if (!m_arguments[index]) {
+            m_arguments[index] = buildArguments(desc);
+        }
+        arguments = g_variant_ref(m_arguments[index]);
+    }
+
+    std::uint32_t replaces = notificationReuse() == NotificationReuse::Replace ? m_serverIds[index].load() : 0;
+    if (replaces == 0) {
+        return arguments;
+    }
+
+    // same tuple with the id to replace swapped in, the children are shared
+    GVariant *children[8];
+    for (std::size_t i = 0; i < 8; i++) {
+        children[i] = g_variant_get_child_value(arguments, i);
+    }
+    g_variant_unref(children[1]);
+    children[1] = g_variant_ref_sink(g_variant_new_uint32(replaces));
+    GVariant *replacing = g_variant_ref_sink(g_variant_new_tuple(children, 8));
+    for (GVariant *child : children) {
+        g_variant_unref(child);
+    }
+    g_variant_unref(arguments);
+    return replacing;
+}
+
+bool DBusNotifier::send(const NotificationDescriptor &desc, std::string *error) {
+    if (!connect(error)) {
+        return false;
+    }
+
+    auto prepareStart = std::chrono::steady_clock::now();
+    GVariant *arguments = this->arguments(desc);
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this]() {
+            return m_inFlight < m_window;
+        });
+        m_inFlight++;
+        m_peakInFlight = std::max(m_peakInFlight, m_inFlight);
+    }
+
+    auto *call = new Call{this, desc.id, arguments, prepareStart, {}};
+    g_main_context_invoke(m_context, &DBusNotifier::issue, call);
+    return true;
+}
+
+gboolean DBusNotifier::issue(gpointer data) {
+    auto *call = static_cast<Call *>(data);
+    call->issued = std::chrono::steady_clock::now();
+    // the reply comes back on this thread, its the thread default context here
+    g_dbus_connection_call(call->self->m_connection, "org.freedesktop.Notifications", "/org/freedesktop/Notifications",
+                           "org.freedesktop.Notifications", "Notify", call->arguments, G_VARIANT_TYPE("(u)"),
+                           G_DBUS_CALL_FLAGS_NONE, -1, nullptr, &DBusNotifier::replied, call);
+    return G_SOURCE_REMOVE;
+}
+
+void DBusNotifier::replied(GObject *source, GAsyncResult *result, gpointer data) {
+    auto *call = static_cast<Call *>(data);
+    GError *error = nullptr;
+    GVariant *reply = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source), result, &error);
+
+    bool ok = reply != nullptr;
+    if (reply) {
+        guint32 serverId = 0;
+        g_variant_get(reply, "(u)", &serverId);
+        std::size_t index = static_cast<std::size_t>(call->id);
+        if (index < notificationCount) {
+            call->self->m_serverIds[index] = serverId;
+        }
+        // replies come in on our thread, same as the signals
+        call->self->m_shown.insert(serverId);
+        if (NotificationEvents::instance().started()) {
+            NotificationEvents::instance().track(serverId, call->id);
+        }
+        g_variant_unref(reply);
+    } else {
+        NotificationMetrics::instance().recordError(error);
+        std::cerr << "error notifying the notification smh: " << (error ? error->message : "no reply") << "\n";
+        g_clear_error(&error);
+    }
+
+    call->self->finished(*call, ok);
+    g_variant_unref(call->arguments);
+    delete call;
+}
+
+void DBusNotifier::finished(const Call &call, bool ok) {
+    NotificationMetrics::instance().recordSend(call.id, ok, call.issued - call.prepareStart,
+                                               std::chrono::steady_clock::now() - call.issued);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inFlight--;
+        if (ok) {
+            m_sent++;
+        } else {
+            m_failed++;
+        }
+    }
+    m_changed.notify_all();
+}
+
+void DBusNotifier::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [this]() {
+        return m_inFlight == 0;
+    });
+}
+
+void DBusNotifier::clear() {
+    std::lock_guard<std::mutex> lock(m_argumentsMutex);
+    for (GVariant *&arguments : m_arguments) {
+        if (arguments) {
+            g_variant_unref(arguments);
+            arguments = nullptr;
+        }
+    }
+}
+
+DBusNotifierStats DBusNotifier::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    DBusNotifierStats stats;
+    stats.sent = m_sent;
+    stats.failed = m_failed;
+    stats.inFlight = m_inFlight;
+    stats.peakInFlight = m_peakInFlight;
+    stats.window = m_window;
+    return stats;
+}
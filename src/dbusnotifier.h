@@ -0,0 +1,96 @@
+#pragma once
+
+#include <gio/gio.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+#include "catalog.h"
+
+// the gdbus backend (thenews --backend gdbus): calls Notify on
+// org.freedesktop.Notifications itself instead of going through libnotify.
+// notify_notification_show waits for the reply before it returns, so every
+// toast costs a full round trip. this fires the call and moves on, with up
+// to window() calls waiting for their reply at once on the one connection,
+// and the replies get handled on a thread of our own. the whole argument
+// tuple of every type is built once and reused as is.
+//
+// send() only says whether the call went out, a server that answers with an
+// error gets printed and counted in NotificationMetrics when the reply is in.
+// animated toasts still go through libnotify, the animator needs a
+// NotifyNotification to re-show
+
+struct DBusNotifierStats {
+    std::uint64_t sent = 0;     // calls the server answered
+    std::uint64_t failed = 0;   // calls that came back with an error
+    std::size_t inFlight = 0;   // waiting for a reply right now
+    std::size_t peakInFlight = 0;
+    std::size_t window = 0;
+};
+
+class DBusNotifier {
+public:
+    static DBusNotifier &instance();
+
+    // how many calls can wait for a reply at once, send() blocks past that.
+    // default 64
+    void setWindow(std::size_t window);
+    std::size_t window() const;
+
+    // false with error filled in if theres no session bus
+    bool send(const NotificationDescriptor &desc, std::string *error = nullptr);
+
+    // blocks until every call sent so far got its reply
+    void wait();
+
+    // forget the prebuilt arguments, they hold on to image hints
+    void clear();
+
+    DBusNotifierStats stats() const;
+
+private:
+    DBusNotifier() = default;
+    ~DBusNotifier();
+    DBusNotifier(const DBusNotifier &) = delete;
+    DBusNotifier &operator=(const DBusNotifier &) = delete;
+
+    struct Call;
+
+    bool connect(std::string *error);
+    GVariant *arguments(const NotificationDescriptor &desc);
+    void run();
+    static gboolean issue(gpointer call);
+    static void replied(GObject *source, GAsyncResult *result, gpointer call);
+    static void onSignal(GDBusConnection *connection, const gchar *sender, const gchar *path, const gchar *interface,
+                         const gchar *signal, GVariant *parameters, gpointer self);
+    static gboolean quit(gpointer loop);
+    void finished(const Call &call, bool ok);
+
+    std::mutex m_connectMutex;
+    GDBusConnection *m_connection = nullptr;
+    guint m_signalSubscription = 0;
+    GMainContext *m_context = nullptr;
+    GMainLoop *m_loop = nullptr;
+    std::thread m_thread;
+
+    mutable std::mutex m_argumentsMutex;
+    std::array<GVariant *, notificationCount> m_arguments{}; // (susssasa{sv}i), replaces_id 0
+    std::array<std::atomic<std::uint32_t>, notificationCount> m_serverIds{}; // for NotificationReuse::Replace
+    std::unordered_set<std::uint32_t> m_shown; // server ids of ours still up, only touched on our thread
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::size_t m_window = 64;
+    std::size_t m_inFlight = 0;
+    std::size_t m_peakInFlight = 0;
+    std::uint64_t m_sent = 0;
+    std::uint64_t m_failed = 0;
+};
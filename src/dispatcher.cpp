@@ -0,0 +1,254 @@
+#include "dispatcher.h"
+
+#include "metrics.h"
+#include "notifications.h"
+
+#include <QMetaObject>
+#include <QObject>
+
+bool parseDispatchPolicy(std::string_view name, DispatchPolicy &out) {
+    if (name == "drop-oldest") {
+        out = DispatchPolicy::DropOldest;
+    } else if (name == "coalesce") {
+        out = DispatchPolicy::Coalesce;
+    } else if (name == "block") {
+        out = DispatchPolicy::Block;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *dispatchPolicyName(DispatchPolicy policy) {
+    switch (policy) {
+        case DispatchPolicy::Coalesce: return "coalesce";
+        case DispatchPolicy::Block: return "block";
+        default: return "drop-oldest";
+    }
+}
+
+NotificationDispatcher::NotificationDispatcher(std::size_t capacity, DispatchPolicy policy)
+    : m_context(g_main_context_new()),
+      m_loop(g_main_loop_new(m_context, FALSE)),
+      m_capacity(capacity > 0 ? capacity : 1),
+      m_policy(policy) {
+    for (auto &lane : m_lanes) {
+        lane = std::make_unique<Lane>(m_capacity);
+    }
+    m_thread = std::thread(&NotificationDispatcher::run, this);
+    NotificationMetrics::instance().addDispatcher(this);
+}
+
+NotificationDispatcher::~NotificationDispatcher() {
+    NotificationMetrics::instance().removeDispatcher(this);
+    {
+        std::lock_guard<std::mutex> lock(m_blockMutex);
+        m_stopping = true;
+    }
+    m_spaceAvailable.notify_all();
+
+    // quitting from inside the loop so it cant get lost before g_main_loop_run starts
+    g_main_context_invoke(m_context, &NotificationDispatcher::quit, m_loop);
+    m_thread.join();
+
+    g_main_loop_unref(m_loop);
+    g_main_context_unref(m_context);
+}
+
+void NotificationDispatcher::run() {
+    // libnotify hooks its d-bus proxy up to the thread default context the
+    // first time its used, so action and close signals end up in ours
+    g_main_context_push_thread_default(m_context);
+    g_main_loop_run(m_loop);
+    g_main_context_pop_thread_default(m_context);
+}
+
+gboolean NotificationDispatcher::quit(gpointer loop) {
+    g_main_loop_quit(static_cast<GMainLoop *>(loop));
+    return G_SOURCE_REMOVE;
+}
+
+void NotificationDispatcher::setCallback(QObject *context, Callback callback) {
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    m_callbackContext = context;
+    m_callback = std::move(callback);
+}
+
+bool NotificationDispatcher::enqueue(NotificationId id) {
+    if (m_stopping) {
+        return false;
+    }
+
+    std::size_t index = static_cast<std::size_t>(id) < notificationCount ? static_cast<std::size_t>(id) : notificationCount;
+    if (m_policy == DispatchPolicy::Coalesce) {
+        // only the producer that takes it from 0 to 1 gets to queue it
+        std::uint32_t none = 0;
+        if (!m_waiting[index].compare_exchange_strong(none, 1)) {
+            m_coalesced++;
+            return false;
+        }
+    } else {
+        m_waiting[index]++;
+    }
+
+    Lane &lane = *m_lanes[static_cast<std::size_t>(dispatchLane(notificationDescriptor(id).urgency))];
+    Job job{id, std::chrono::steady_clock::now()};
+    while (!lane.queue.push(job)) {
+        if (m_policy == DispatchPolicy::Block) {
+            m_blocked++;
+            // pairs with the fence in drain after a pop, either it sees us blocked or we see the room it made
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::unique_lock<std::mutex> lock(m_blockMutex);
+            m_spaceAvailable.wait(lock, [this, &lane]() {
+                return m_stopping || m_policy != DispatchPolicy::Block || lane.queue.size() < lane.queue.capacity();
+            });
+            m_blocked--;
+            if (m_stopping) {
+                m_waiting[index]--;
+                return false;
+            }
+            continue;
+        }
+
+        // full, throw out the oldest one in this lane. another producer might
+        // beat us to the room we made, then we just go around again
+        Job oldest;
+        if (lane.queue.pop(oldest)) {
+            forget(oldest);
+            lane.dropped++;
+        }
+    }
+    lane.queued++;
+    m_queued++;
+
+    // pairs with the fence in drain, so a drain that just found everything
+    // empty either sees this toast or gets scheduled again by us
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!m_drainScheduled.exchange(true)) {
+        g_main_context_invoke(m_context, &NotificationDispatcher::drain, this);
+    }
+    return true;
+}
+
+void NotificationDispatcher::forget(const Job &job) {
+    std::size_t index = static_cast<std::size_t>(job.id) < notificationCount ? static_cast<std::size_t>(job.id) : notificationCount;
+    m_waiting[index]--;
+}
+
+bool NotificationDispatcher::popNext(Job &job) {
+    for (auto &lane : m_lanes) {
+        if (lane->queue.pop(job)) {
+            forget(job);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::size_t NotificationDispatcher::depth() const {
+    std::size_t depth = 0;
+    for (const auto &lane : m_lanes) {
+        depth += lane->queue.size();
+    }
+    return depth;
+}
+
+gboolean NotificationDispatcher::drain(gpointer self) {
+    auto *dispatcher = static_cast<NotificationDispatcher *>(self);
+
+    Job job;
+    if (dispatcher->m_stopping || !dispatcher->popNext(job)) {
+        dispatcher->m_drainScheduled = false;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // a toast that came in between the pop and clearing the flag didnt
+        // schedule us, so look once more before going to sleep
+        if (dispatcher->m_stopping || dispatcher->depth() == 0 || dispatcher->m_drainScheduled.exchange(true)) {
+            return G_SOURCE_REMOVE;
+        }
+        return G_SOURCE_CONTINUE;
+    }
+
+    // pairs with the fence a blocked producer does after m_blocked++. the pop
+    // and that bump are stores on two threads each followed by a load of the
+    // others, so without both fences we could miss it and it could miss the
+    // room we just made, and then it sleeps with nobody left to wake it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (dispatcher->m_blocked > 0) {
+        std::lock_guard<std::mutex> lock(dispatcher->m_blockMutex);
+        dispatcher->m_spaceAvailable.notify_all();
+    }
+
+    DispatchResult result;
+    result.id = job.id;
+
+    auto start = std::chrono::steady_clock::now();
+    result.ok = sendNotification(job.id, &result.error);
+    auto end = std::chrono::steady_clock::now();
+
+    result.waited = start - job.queuedAt;
+    result.sent = end - start;
+    NotificationMetrics::instance().recordQueueWait(result.waited);
+    dispatcher->deliver(result);
+
+    // one toast per dispatch so d-bus signals for this context get a turn in
+    // between, we get called again right away if theres more
+    return G_SOURCE_CONTINUE;
+}
+
+void NotificationDispatcher::deliver(const DispatchResult &result) {
+    if (result.ok) {
+        m_sent++;
+    } else {
+        m_failed++;
+    }
+
+    QObject *context;
+    Callback callback;
+    {
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        context = m_callbackContext;
+        callback = m_callback;
+    }
+
+    if (!callback) {
+        return;
+    }
+    if (context) {
+        QMetaObject::invokeMethod(context, [callback, result]() {
+            callback(result);
+        }, Qt::QueuedConnection);
+    } else {
+        callback(result);
+    }
+}
+
+void NotificationDispatcher::setPolicy(DispatchPolicy policy) {
+    {
+        std::lock_guard<std::mutex> lock(m_blockMutex);
+        m_policy = policy;
+    }
+    // anyone blocked under the old policy gets to re-check
+    m_spaceAvailable.notify_all();
+}
+
+DispatchPolicy NotificationDispatcher::policy() const {
+    return m_policy;
+}
+
+DispatchStats NotificationDispatcher::stats() const {
+    DispatchStats stats;
+    stats.queued = m_queued;
+    stats.sent = m_sent;
+    stats.failed = m_failed;
+    stats.coalesced = m_coalesced;
+    stats.capacity = m_capacity;
+    for (std::size_t i = 0; i < dispatchLaneCount; i++) {
+        const Lane &lane = *m_lanes[i];
+        stats.lanes[i].queued = lane.queued;
+        stats.lanes[i].dropped = lane.dropped;
+        stats.lanes[i].depth = lane.queue.size();
+        stats.dropped += stats.lanes[i].dropped;
+        stats.depth += stats.lanes[i].depth;
+    }
+    return stats;
+}
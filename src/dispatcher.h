@@ -0,0 +1,160 @@
+#pragma once
+
+#include <glib.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "boundedqueue.h"
+#include "catalog.h"
+
+class QObject;
+
+// sends notifications from its own thread running its own GMainContext, so a
+// slow notification daemon only ever stalls that thread and not the gui.
+// the gui, the auto toast and the daemon socket just drop ids into bounded
+// lock-free queues (see boundedqueue.h) and get told how it went later.
+// theres one queue per urgency and the sender always empties the critical
+// one first, so a servers dying toast doesnt wait behind a pile of news
+
+enum class DispatchPolicy : std::uint8_t {
+    DropOldest, // queue full? throw out the oldest waiting toast
+    Coalesce,   // same toast already waiting? dont queue it twice (drops oldest when full)
+    Block       // queue full? wait until theres room
+};
+
+bool parseDispatchPolicy(std::string_view name, DispatchPolicy &out);
+const char *dispatchPolicyName(DispatchPolicy policy);
+
+// in the order the sender looks at them
+enum class DispatchLane : std::uint8_t {
+    Critical,
+    Normal,
+    Low,
+    Count
+};
+
+constexpr std::size_t dispatchLaneCount = static_cast<std::size_t>(DispatchLane::Count);
+
+constexpr DispatchLane dispatchLane(NotificationUrgency urgency) {
+    switch (urgency) {
+        case NotificationUrgency::Critical: return DispatchLane::Critical;
+        case NotificationUrgency::Low: return DispatchLane::Low;
+        default: return DispatchLane::Normal;
+    }
+}
+
+constexpr const char *dispatchLaneName(DispatchLane lane) {
+    switch (lane) {
+        case DispatchLane::Critical: return "critical";
+        case DispatchLane::Low: return "low";
+        default: return "normal";
+    }
+}
+
+struct DispatchResult {
+    NotificationId id;
+    bool ok;
+    std::string error;
+    std::chrono::steady_clock::duration waited; // time spent sitting in the queue
+    std::chrono::steady_clock::duration sent;   // time spent in sendNotification
+};
+
+struct DispatchLaneStats {
+    std::uint64_t queued = 0;
+    std::uint64_t dropped = 0;
+    std::size_t depth = 0;
+};
+
+struct DispatchStats {
+    std::uint64_t queued = 0;
+    std::uint64_t sent = 0;
+    std::uint64_t failed = 0;
+    std::uint64_t dropped = 0;
+    std::uint64_t coalesced = 0;
+    std::size_t depth = 0;    // all lanes
+    std::size_t capacity = 0; // per lane
+    std::array<DispatchLaneStats, dispatchLaneCount> lanes;
+};
+
+class NotificationDispatcher {
+public:
+    using Callback = std::function<void(const DispatchResult &)>;
+
+    explicit NotificationDispatcher(std::size_t capacity = 64, DispatchPolicy policy = DispatchPolicy::DropOldest);
+    ~NotificationDispatcher();
+
+    NotificationDispatcher(const NotificationDispatcher &) = delete;
+    NotificationDispatcher &operator=(const NotificationDispatcher &) = delete;
+
+    // called after every send. with a context the callback is queued onto
+    // that QObject's thread, without one it runs on the dispatch thread
+    void setCallback(QObject *context, Callback callback);
+
+    // false if the toast got coalesced away or the dispatcher is shutting down.
+    // safe from any thread, and doesnt take a lock unless the policy is Block
+    // and the lane is full
+    bool enqueue(NotificationId id);
+
+    void setPolicy(DispatchPolicy policy);
+    DispatchPolicy policy() const;
+
+    DispatchStats stats() const;
+
+private:
+    struct Job {
+        NotificationId id;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    struct Lane {
+        explicit Lane(std::size_t capacity) : queue(capacity) {}
+        BoundedQueue<Job> queue;
+        std::atomic<std::uint64_t> queued{0};
+        std::atomic<std::uint64_t> dropped{0};
+    };
+
+    void run();
+    static gboolean drain(gpointer self);
+    static gboolean quit(gpointer loop);
+    bool popNext(Job &job);
+    void forget(const Job &job);
+    std::size_t depth() const;
+    void deliver(const DispatchResult &result);
+
+    GMainContext *m_context;
+    GMainLoop *m_loop;
+    std::thread m_thread;
+
+    std::array<std::unique_ptr<Lane>, dispatchLaneCount> m_lanes;
+    std::size_t m_capacity;
+    // how many of each toast are waiting, so Coalesce doesnt have to look
+    std::array<std::atomic<std::uint32_t>, notificationCount + 1> m_waiting{};
+    std::atomic<DispatchPolicy> m_policy;
+    std::atomic<bool> m_drainScheduled{false};
+    std::atomic<bool> m_stopping{false};
+
+    // only for Block, producers sleep here while their lane is full
+    std::mutex m_blockMutex;
+    std::condition_variable m_spaceAvailable;
+    std::atomic<int> m_blocked{0};
+
+    mutable std::mutex m_callbackMutex;
+    QObject *m_callbackContext = nullptr;
+    Callback m_callback;
+
+    std::atomic<std::uint64_t> m_queued{0};
+    std::atomic<std::uint64_t> m_sent{0};
+    std::atomic<std::uint64_t> m_failed{0};
+    std::atomic<std::uint64_t> m_coalesced{0};
+};
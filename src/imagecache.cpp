@@ -0,0 +1,263 @@
+#include "imagecache.h"
+
+#include "assetpack.h"
+
+#include <iostream>
+
+#include <QImage>
+#include <QString>
+
+namespace {
+
+constexpr std::size_t defaultCapacity = 64 * 1024 * 1024;
+
+// notification daemons show icons at 48-128px anyway, 256 leaves room for
+// hidpi and the bigger popups some of them do
+constexpr int defaultMaxDimension = 256;
+
+void deleteImage(gpointer image) {
+    delete static_cast<QImage *>(image);
+}
+
+} // namespace
+
+ImageCache &ImageCache::instance() {
+    static ImageCache cache;
+    return cache;
+}
+
+ImageCache::ImageCache() : m_capacity(defaultCapacity), m_maxDimension(defaultMaxDimension) {}
+
+ImageCache::~ImageCache() {
+    clear();
+}
+
+GVariant *ImageCache::decode(const char *resourcePath, int maxDimension, bool packRgb, ImageSize &dimensions) {
+    QImage image(QString::fromUtf8(resourcePath));
+    if (image.isNull()) {
+        return nullptr;
+    }
+
+    dimensions.originalWidth = image.width();
+    dimensions.originalHeight = image.height();
+    dimensions.originalBytes = static_cast<std::size_t>(image.width()) * image.height() * 4;
+
+    // scaled once here and cached, so the smooth (slow) filter is fine
+    if (maxDimension > 0 && (image.width() > maxDimension || image.height() > maxDimension)) {
+        image = image.scaled(maxDimension, maxDimension, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    bool rgb = packRgb && !image.hasAlphaChannel();
+    int channels = rgb ? 3 : 4;
+
+    // the GBytes points straight at the converted QImage and deletes it when
+    // the last ref goes away, so the pixels only get copied by the conversion
+    QImage *pixels = new QImage(image.convertToFormat(rgb ? QImage::Format_RGB888 : QImage::Format_RGBA8888));
+    std::size_t size = static_cast<std::size_t>(pixels->sizeInBytes());
+
+    dimensions.width = pixels->width();
+    dimensions.height = pixels->height();
+    dimensions.channels = channels;
+    dimensions.bytes = size;
+
+    GBytes *bytes = g_bytes_new_with_free_func(pixels->constBits(), size, deleteImage, pixels);
+
+    GVariant *imageData = g_variant_new("(iiibii@ay)",
+        pixels->width(), pixels->height(), static_cast<int>(pixels->bytesPerLine()), rgb ? FALSE : TRUE, 8, channels,
+        g_variant_new_from_bytes(G_VARIANT_TYPE_BYTESTRING, bytes, TRUE)
+    );
+    g_bytes_unref(bytes);
+
+    return g_variant_ref_sink(imageData);
+}
+
+GVariant *ImageCache::imageData(const char *resourcePath) {
+    std::string key(resourcePath);
+    int maxDimension;
+    bool packRgb;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            m_hits++;
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+            return it->second.data ? g_variant_ref(it->second.data) : nullptr;
+        }
+        m_misses++;
+        maxDimension = m_maxDimension;
+        packRgb = m_packOpaqueAsRgb;
+    }
+
+    // the pack already has it converted, and its pixels are mapped instead
+    // of on the heap so they dont count against the capacity
+    ImageSize dimensions;
+    GVariant *data = AssetPack::instance().imageData(resourcePath, maxDimension, packRgb, dimensions);
+    bool mapped = data != nullptr;
+    if (!mapped) {
+        // decode without holding the lock so nobody waits on a jpeg they dont need
+        data = decode(resourcePath, maxDimension, packRgb, dimensions);
+    }
+    std::size_t size = mapped ? 0 : dimensions.bytes;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        // someone else decoded it while we were busy, use theirs
+        if (data) {
+            g_variant_unref(data);
+        }
+        return it->second.data ? g_variant_ref(it->second.data) : nullptr;
+    }
+
+    if (mapped) {
+        m_mapped++;
+    }
+    if (!data) {
+        m_failures++;
+        std::cerr << "the image is corrupted or not there idfk: " << resourcePath << "\n";
+    } else if (size > m_capacity) {
+        // too big to ever fit, hand it over without caching it
+        return data;
+    }
+
+    m_lru.push_front(key);
+    m_entries.emplace(std::move(key), Entry{data, size, dimensions, m_lru.begin()});
+    m_bytes += size;
+    evictLocked();
+
+    return data ? g_variant_ref(data) : nullptr;
+}
+
+GVariant *ImageCache::imageData(ResourceId id) {
+    if (id == ResourceId::None) {
+        return nullptr;
+    }
+    std::size_t index = static_cast<std::size_t>(id);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry *entry = m_byId[index];
+        if (entry) {
+            m_hits++;
+            m_lru.splice(m_lru.begin(), m_lru, entry->lru);
+            return entry->data ? g_variant_ref(entry->data) : nullptr;
+        }
+    }
+
+    // first time for this id (or it got evicted), go the long way once
+    const char *path = resourcePath(id);
+    GVariant *data = imageData(path);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(path);
+    if (it != m_entries.end()) {
+        it->second.id = id;
+        m_byId[index] = &it->second;
+    }
+    return data;
+}
+
+void ImageCache::evictLocked() {
+    while (m_bytes > m_capacity && !m_lru.empty()) {
+        auto it = m_entries.find(m_lru.back());
+        if (it->second.id != ResourceId::None) {
+            m_byId[static_cast<std::size_t>(it->second.id)] = nullptr;
+        }
+        m_bytes -= it->second.size;
+        if (it->second.data) {
+            g_variant_unref(it->second.data);
+        }
+        m_entries.erase(it);
+        m_lru.pop_back();
+        m_evictions++;
+    }
+}
+
+void ImageCache::setCapacity(std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = bytes;
+    evictLocked();
+}
+
+std::size_t ImageCache::capacity() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capacity;
+}
+
+void ImageCache::setMaxDimension(int pixels) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_maxDimension == pixels) {
+            return;
+        }
+        m_maxDimension = pixels;
+    }
+    clear();
+}
+
+int ImageCache::maxDimension() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxDimension;
+}
+
+void ImageCache::setPackOpaqueAsRgb(bool pack) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_packOpaqueAsRgb == pack) {
+            return;
+        }
+        m_packOpaqueAsRgb = pack;
+    }
+    clear();
+}
+
+bool ImageCache::packOpaqueAsRgb() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_packOpaqueAsRgb;
+}
+
+bool ImageCache::imageSize(const char *resourcePath, ImageSize &out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(resourcePath);
+    if (it == m_entries.end() || !it->second.data) {
+        return false;
+    }
+    out = it->second.dimensions;
+    return true;
+}
+
+bool ImageCache::imageSize(ResourceId id, ImageSize &out) const {
+    return id != ResourceId::None && imageSize(resourcePath(id), out);
+}
+
+void ImageCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &entry : m_entries) {
+        if (entry.second.data) {
+            g_variant_unref(entry.second.data);
+        }
+    }
+    m_entries.clear();
+    m_byId.fill(nullptr);
+    m_lru.clear();
+    m_bytes = 0;
+}
+
+ImageCacheStats ImageCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ImageCacheStats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    stats.failures = m_failures;
+    stats.mapped = m_mapped;
+    stats.entries = m_entries.size();
+    stats.bytes = m_bytes;
+    stats.capacity = m_capacity;
+    for (const auto &entry : m_entries) {
+        stats.originalBytes += entry.second.dimensions.originalBytes;
+    }
+    return stats;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <glib.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "resourceids.h"
+
+// decoded notification images, keyed by resource path.
+// decoding a jpeg and converting it to rgba on every single toast is slow, so
+// each image gets decoded once and the ready to attach image-data variant is
+// kept around. once the pixels add up to more than capacity() bytes the least
+// recently used images get thrown out.
+// every toast ships its pixels over d-bus, so images bigger than
+// maxDimension() get scaled down first and opaque ones are sent as rgb
+// instead of rgba. a full size astolfo.jpg is megabytes per toast otherwise
+
+struct ImageCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+    std::uint64_t failures = 0; // images that didnt decode
+    std::uint64_t mapped = 0;   // misses served straight from thenews.pack, see assetpack.h
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+    std::size_t capacity = 0;
+    std::size_t originalBytes = 0; // what the cached images would be at full size in rgba
+};
+
+// what one image looks like on the wire compared to the original
+struct ImageSize {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::size_t bytes = 0;
+    int originalWidth = 0;
+    int originalHeight = 0;
+    std::size_t originalBytes = 0; // full size rgba, what we used to send
+};
+
+class ImageCache {
+public:
+    static ImageCache &instance();
+
+    // the (iiibii@ay) image-data hint for resourcePath, nullptr if it cant be
+    // decoded. you get your own ref so g_variant_unref it when youre done
+    GVariant *imageData(const char *resourcePath);
+    // same thing without hashing a path, what sendNotification uses
+    GVariant *imageData(ResourceId id);
+
+    void setCapacity(std::size_t bytes);
+    std::size_t capacity() const;
+
+    // longest side in pixels an image gets sent at, 0 sends them as they are.
+    // changing it (or the rgb packing) throws away everything cached
+    void setMaxDimension(int pixels);
+    int maxDimension() const;
+
+    // send images without any transparency as 3 channel rgb
+    void setPackOpaqueAsRgb(bool pack);
+    bool packOpaqueAsRgb() const;
+
+    // false if resourcePath isnt cached (or didnt decode)
+    bool imageSize(const char *resourcePath, ImageSize &out) const;
+    bool imageSize(ResourceId id, ImageSize &out) const;
+
+    void clear();
+    ImageCacheStats stats() const;
+
+private:
+    struct Entry {
+        GVariant *data; // nullptr if the image is broken, so we dont retry it every toast
+        std::size_t size;
+        ImageSize dimensions;
+        std::list<std::string>::iterator lru;
+        ResourceId id = ResourceId::None; // set once m_byId points here
+    };
+
+    ImageCache();
+    ~ImageCache();
+    ImageCache(const ImageCache &) = delete;
+    ImageCache &operator=(const ImageCache &) = delete;
+
+    static GVariant *decode(const char *resourcePath, int maxDimension, bool packRgb, ImageSize &dimensions);
+    void evictLocked();
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::array<Entry *, resourceCount> m_byId{}; // map elements dont move, so these stay valid until evicted
+    std::list<std::string> m_lru; // front is the most recently used
+    std::size_t m_bytes = 0;
+    std::size_t m_capacity;
+    int m_maxDimension;
+    bool m_packOpaqueAsRgb = true;
+    std::uint64_t m_hits = 0;
+    std::uint64_t m_misses = 0;
+    std::uint64_t m_evictions = 0;
+    std::uint64_t m_failures = 0;
+    std::uint64_t m_mapped = 0;
+};
@@ -0,0 +1,101 @@
+#include "imagefiles.h"
+
+#include <iostream>
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QString>
+
+ImageFileCache &ImageFileCache::instance() {
+    static ImageFileCache cache;
+    return cache;
+}
+
+ImageFileCache::ImageFileCache()
+    : m_directory((QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/thenews").toStdString()) {}
+
+std::string ImageFileCache::directory() const {
+    return m_directory;
+}
+
+std::string ImageFileCache::path(const char *resourcePath) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return pathLocked(resourcePath);
+}
+
+std::string ImageFileCache::path(ResourceId id) {
+    if (id == ResourceId::None) {
+        return {};
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const std::string *&known = m_byId[static_cast<std::size_t>(id)];
+    if (!known) {
+        pathLocked(resourcePath(id));
+        known = &m_paths.find(resourcePath(id))->second;
+    }
+    return *known;
+}
+
+std::string ImageFileCache::pathLocked(const char *resourcePath) {
+    auto it = m_paths.find(resourcePath);
+    if (it != m_paths.end()) {
+        return it->second;
+    }
+
+    // only the first toast of each image gets here, holding the lock keeps
+    // two threads from writing the same file at once
+    std::string file = extract(resourcePath);
+    m_paths.emplace(resourcePath, file);
+    return file;
+}
+
+std::string ImageFileCache::extract(const char *resourcePath) {
+    QFile resource(QString::fromUtf8(resourcePath));
+    if (!resource.open(QIODevice::ReadOnly)) {
+        m_stats.failures++;
+        return {};
+    }
+    QByteArray contents = resource.readAll();
+    QByteArray hash = QCryptographicHash::hash(contents, QCryptographicHash::Sha256);
+
+    QString suffix = QFileInfo(resource.fileName()).suffix();
+    QString fileName = QString::fromLatin1(hash.toHex()) + (suffix.isEmpty() ? QString() : "." + suffix);
+    QDir dir(QString::fromStdString(m_directory));
+    QString filePath = dir.filePath(fileName);
+
+    QFile existing(filePath);
+    if (existing.open(QIODevice::ReadOnly)) {
+        if (existing.size() == contents.size() &&
+            QCryptographicHash::hash(existing.readAll(), QCryptographicHash::Sha256) == hash) {
+            m_stats.verified++;
+            return filePath.toStdString();
+        }
+        existing.close();
+    }
+
+    // QSaveFile writes to a temp file and renames it over, so a notification
+    // daemon never sees half an image
+    if (!dir.mkpath(".")) {
+        m_stats.failures++;
+        std::cerr << "cant create " << m_directory << ", sending images inline\n";
+        return {};
+    }
+    QSaveFile out(filePath);
+    if (!out.open(QIODevice::WriteOnly) || out.write(contents) != contents.size() || !out.commit()) {
+        m_stats.failures++;
+        std::cerr << "cant write " << filePath.toStdString() << ", sending it inline\n";
+        return {};
+    }
+    m_stats.written++;
+    return filePath.toStdString();
+}
+
+ImageFileStats ImageFileCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
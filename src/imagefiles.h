@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "resourceids.h"
+
+// notification images as real files, for the image-path hint. each qrc
+// resource gets written once to $XDG_CACHE_HOME/thenews/<sha256>.<ext> and
+// from then on a toast only carries the path instead of all the pixels.
+// files are named after the hash of what should be in them, so a stale or
+// damaged one gets noticed (and rewritten) the first time its used
+
+struct ImageFileStats {
+    std::uint64_t written = 0;  // files we had to create or repair
+    std::uint64_t verified = 0; // files that were already there and checked out
+    std::uint64_t failures = 0; // resources we couldnt read or write
+};
+
+class ImageFileCache {
+public:
+    static ImageFileCache &instance();
+
+    // absolute path of the file for resourcePath, extracted on first use.
+    // empty if the resource doesnt exist or the cache dir isnt writable
+    std::string path(const char *resourcePath);
+    std::string path(ResourceId id);
+
+    // $XDG_CACHE_HOME/thenews
+    std::string directory() const;
+
+    ImageFileStats stats() const;
+
+private:
+    ImageFileCache();
+    ImageFileCache(const ImageFileCache &) = delete;
+    ImageFileCache &operator=(const ImageFileCache &) = delete;
+
+    std::string pathLocked(const char *resourcePath);
+    std::string extract(const char *resourcePath);
+
+    mutable std::mutex m_mutex;
+    std::string m_directory;
+    std::unordered_map<std::string, std::string> m_paths; // resource -> checked file, "" if it failed
+    std::array<const std::string *, resourceCount> m_byId{}; // into m_paths
+    ImageFileStats m_stats;
+};
@@ -1,938 +1,418 @@
-#include <glib.h>
-#include <libnotify/notify.h>
 #include <iostream>
+#include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include "animation.h"
+#include "assetpack.h"
+#include "batch.h"
+#include "catalog.h"
+#include "control.h"
+#include "daemon.h"
+#include "dbusnotifier.h"
+#include "dispatcher.h"
+#include "imagecache.h"
+#include "imagefiles.h"
+#include "metrics.h"
+#include "notificationevents.h"
+#include "notifications.h"
+
+#include "newswindow.h"
+#include "startupprofile.h"
 
 #include <QApplication>
-#include <QWidget>
-#include <QPushButton>
-#include <QStackedWidget>
-#include "ui_page1.h"
-#include "ui_page2.h"
-#include <QLabel>
+#include <QCoreApplication>
+#include <QEvent>
 #include <QFontDatabase>
-#include <QFile>
-#include <QImage>
-#include <QBuffer>
-#include <QPainter>
-#include <QStyleOption>
-#include <QStandardPaths>
-#include <QDir>
-#include <QTextStream>
 #include <QTimer>
-#include <QSlider>
-#include <QHBoxLayout>
-#include <QCoreApplication>
 
-class SkewedButton : public QPushButton {
-public:
-    SkewedButton(QWidget *parent = nullptr) : QPushButton(parent) {
-        setAttribute(Qt::WA_TranslucentBackground, false);
-        setAttribute(Qt::WA_OpaquePaintEvent, false);
-    }
-    
-    void setSkewTransform(double skewX, double skewY, double translateX = 0, double translateY = 0, double rotation = 0) {
-        m_skewX = skewX;
-        m_skewY = skewY;
-        m_translateX = translateX;
-        m_translateY = translateY;
-        m_rotation = rotation;
-        
-        QTransform transform;
-        QPointF center(width() / 2.0, height() / 2.0);
-        transform.translate(center.x(), center.y());
-        if (m_rotation != 0) {
-            transform.rotate(m_rotation);
-        }
-        double shearX = qTan(qDegreesToRadians(m_skewX));
-        double shearY = qTan(qDegreesToRadians(m_skewY));
-        transform.shear(shearX, shearY);
-        transform.translate(-center.x(), -center.y());
-        
-        QRectF transformedRect = transform.mapRect(QRectF(rect()));
-        
-        QRect originalGeom = geometry();
-        int extraLeft = qMax(0.0, -transformedRect.left());
-        int extraTop = qMax(0.0, -transformedRect.top());
-        int extraRight = qMax(0.0, transformedRect.right() - rect().width());
-        int extraBottom = qMax(0.0, transformedRect.bottom() - rect().height());
-        
-        m_originalRect = QRect(extraLeft, extraTop, originalGeom.width(), originalGeom.height());
-        
-        setGeometry(
-            originalGeom.x() - extraLeft,
-            originalGeom.y() - extraTop,
-            originalGeom.width() + extraLeft + extraRight,
-            originalGeom.height() + extraTop + extraBottom
-        );
-        
-        update();
+void printHelp() {
+    std::cout << "the news cli!\n\n";
+    std::cout << "usage: thenews [OPTION]...\n\n";
+    std::cout << "options:\n";
+    std::cout << "  --help                show this help message\n";
+    std::cout << "  --h                   show the h\n";
+    std::cout << "  --stats               print image cache, notification pool and dispatch stats before exiting\n";
+    std::cout << "  --stats-interval S    log a line of send counts and latencies to stderr every S seconds\n";
+    std::cout << "  --metrics-socket PATH serve prometheus metrics on a unix socket (curl --unix-socket PATH localhost/metrics)\n";
+    std::cout << "  --startup-profile     print how long each step of opening the window took\n";
+    std::cout << "  --image-cache-mb N    keep at most N MiB of decoded images around (default 64)\n";
+    std::cout << "  --image-max-size PX   scale toast images down to at most PX pixels per side (default 256, 0 for full size)\n";
+    std::cout << "  --asset-pack FILE     take toast images from this pack instead of the one next to the executable\n";
+    std::cout << "  --no-asset-pack       decode toast images from the embedded resources every time\n";
+    std::cout << "  --image-path          send toast images as files in ~/.cache/thenews instead of the pixels\n";
+    std::cout << "  --animate             animated toast images (the h) keep playing instead of showing the first frame\n";
+    std::cout << "  --animation-cpu PCT   how much of one core animated toasts may use between them (default 5)\n";
+    std::cout << "  --animation-seconds S stop animating a toast after S seconds (default 30)\n";
+    std::cout << "  --image-rgba          always send toast images with an alpha channel, even opaque ones\n";
+    std::cout << "  --dispatch-policy P   what the ui does when toasts pile up: drop-oldest (default), coalesce or block\n";
+    std::cout << "  --dispatch-queue N    how many toasts of each urgency the ui lets pile up (default 64)\n";
+    std::cout << "  --max-toast-rate N    the auto toast sends at most N toasts per second (default no limit)\n";
+    std::cout << "  --playlist P          what the auto toast sends: classic (default), sequential, random or weighted\n";
+    std::cout << "  --backend B           how toasts get to the server: libnotify (default) or gdbus, which doesnt wait for each reply\n";
+    std::cout << "  --dbus-window N       with --backend gdbus, how many toasts can wait for their reply at once (default 64)\n";
+    std::cout << "  --replace-toasts      repeated toasts replace the one on screen instead of stacking\n";
+    std::cout << "  --repeat N            send everything N times\n";
+    std::cout << "  --interval MS         wait MS milliseconds between toasts\n";
+    std::cout << "  --list FILE           also send the ids in FILE, one per line (- reads stdin)\n";
+    std::cout << "  --wait                stay until an action on one of the toasts gets clicked and print its id,\n";
+    std::cout << "                        exits 2 without printing anything if they all got closed instead\n";
+    std::cout << "  --wait-timeout S      stop waiting after S seconds and exit 3\n";
+    std::cout << "  --daemon              stay running and send toasts asked for on the control socket\n";
+    std::cout << "  --send ID             ask the running daemon to send ID and exit right away\n";
+    std::cout << "  --socket PATH         control socket to use (default $XDG_RUNTIME_DIR/thenews.sock)\n";
+    for (const auto &desc : notificationCatalog) {
+        std::string flag = "--" + std::string(desc.key);
+        std::cout << "  " << flag << std::string(flag.size() < 22 ? 22 - flag.size() : 1, ' ') << desc.help << "\n";
     }
-    
-protected:
-    void paintEvent(QPaintEvent *event) override {
-        QPainter painter(this);
-        painter.setRenderHint(QPainter::Antialiasing);
-        painter.setRenderHint(QPainter::SmoothPixmapTransform);
-        
-        QTransform transform;
-        
-        QRectF drawRect = m_originalRect.isNull() ? rect() : m_originalRect;
-        QPointF center(drawRect.center());
-        
-        transform.translate(center.x(), center.y());
-        
-        if (m_rotation != 0) {
-            transform.rotate(m_rotation);
-        }
-        
-        double shearX = qTan(qDegreesToRadians(m_skewX));
-        double shearY = qTan(qDegreesToRadians(m_skewY));
-        transform.shear(shearX, shearY);
-        
-        transform.translate(-center.x(), -center.y());
-        
-        painter.setTransform(transform);
-        
-        QColor bgColor = palette().color(QPalette::Active, QPalette::Button);
-        QColor borderColor = Qt::black;
-        
-        if (isDown()) {
-            bgColor = bgColor.darker(120);
-        } else if (underMouse()) {
-            bgColor = bgColor.lighter(110);
+    std::cout << "\n";
+    std::cout << "notification options can be combined, they get sent in order and a summary is printed\n";
+    std::cout << "if no notification is provided, the news ui will launch\n";
+}
+
+void printStats(const NotificationDispatcher *dispatcher = nullptr) {
+    ImageCacheStats cache = ImageCache::instance().stats();
+    std::cout << "image cache: " << cache.hits << " hits, " << cache.misses << " misses (" << cache.mapped << " from the pack), "
+              << cache.failures << " failed, " << cache.evictions << " evicted, "
+              << cache.entries << " images in " << cache.bytes / 1024 << "/" << cache.capacity / 1024 << " KiB"
+              << " (" << cache.originalBytes / 1024 << " KiB at full size)\n";
+    for (const auto &desc : notificationCatalog) {
+        ImageSize size;
+        if (ImageCache::instance().imageSize(desc.image, size)) {
+            std::cout << "  " << desc.key << ": " << size.bytes / 1024 << " KiB per toast (" << size.width << "x" << size.height
+                      << (size.channels == 3 ? " rgb" : " rgba") << "), was " << size.originalBytes / 1024 << " KiB ("
+                      << size.originalWidth << "x" << size.originalHeight << ")\n";
         }
-        
-        painter.fillRect(drawRect.toRect(), bgColor);
-        
-        painter.setPen(QPen(borderColor, 1));
-        painter.drawRect(drawRect.toRect().adjusted(0, 0, -1, -1));
-        
-        painter.setPen(palette().color(QPalette::ButtonText));
-        QFont font = this->font();
-        painter.setFont(font);
-        painter.drawText(drawRect.toRect(), Qt::AlignCenter, text());
     }
-    
-    void enterEvent(QEnterEvent *event) override {
-        update();
-        QPushButton::enterEvent(event);
+    if (notificationImageMode() == NotificationImageMode::Path) {
+        ImageFileStats files = ImageFileCache::instance().stats();
+        std::cout << "image files: " << files.written << " written, " << files.verified << " already there, "
+                  << files.failures << " failed, in " << ImageFileCache::instance().directory() << "\n";
     }
-    
-    void leaveEvent(QEvent *event) override {
-        update();
-        QPushButton::leaveEvent(event);
+    if (notificationAnimation()) {
+        AnimationStats animation = NotificationAnimator::instance().stats();
+        std::cout << "animation: " << animation.started << " started, " << animation.framesShown << " frames shown, "
+                  << animation.framesDropped << " dropped, " << animation.cpuMs << " ms cpu\n";
     }
-    
-    void mousePressEvent(QMouseEvent *event) override {
-        update();
-        QPushButton::mousePressEvent(event);
+    if (notificationBackend() == NotificationBackend::GDBus) {
+        DBusNotifierStats dbus = DBusNotifier::instance().stats();
+        std::cout << "gdbus: " << dbus.sent << " answered, " << dbus.failed << " failed, " << dbus.inFlight
+                  << " still out, at most " << dbus.peakInFlight << "/" << dbus.window << " in flight\n";
     }
-    
-    void mouseReleaseEvent(QMouseEvent *event) override {
-        update();
-        QPushButton::mouseReleaseEvent(event);
+    NotificationPoolStats pool = notificationPoolStats();
+    std::uint64_t sends = pool.created + pool.reused;
+    std::cout << "notification pool: " << pool.pooled << " pooled, " << pool.created << " built, "
+              << pool.reused << " reused (" << (sends ? pool.reused * 100 / sends : 0) << "% reuse)\n";
+    if (dispatcher) {
+        DispatchStats dispatch = dispatcher->stats();
+        std::cout << "dispatch (" << dispatchPolicyName(dispatcher->policy()) << "): "
+                  << dispatch.queued << " queued, " << dispatch.sent << " sent, " << dispatch.failed << " failed, "
+                  << dispatch.dropped << " dropped, " << dispatch.coalesced << " coalesced, "
+                  << dispatch.depth << " waiting\n";
+        for (std::size_t i = 0; i < dispatchLaneCount; i++) {
+            const DispatchLaneStats &lane = dispatch.lanes[i];
+            std::cout << "  " << dispatchLaneName(static_cast<DispatchLane>(i)) << ": " << lane.queued << " queued, "
+                      << lane.dropped << " dropped, " << lane.depth << "/" << dispatch.capacity << " waiting\n";
+        }
     }
-    
-private:
-    double m_skewX = 0;
-    double m_skewY = 0;
-    double m_translateX = 0;
-    double m_translateY = 0;
-    double m_rotation = 0;
-    QRect m_originalRect;
-};
+    NotificationMetrics::instance().print(std::cout);
+}
 
-void createHDesktopFile() {
-    // free downloadable h
-    QString applicationsPath = QStandardPaths::writableLocation(QStandardPaths::ApplicationsLocation);
-    
-    QDir dir(applicationsPath);
-    if (!dir.exists()) {
-        dir.mkpath(".");
+// thenews --wait, once the toasts are out
+int waitForToasts(std::chrono::seconds timeout) {
+    NotificationEventStats events = NotificationEvents::instance().stats();
+    if (events.tracked + events.actions + events.closed == 0) {
+        std::cerr << "none of the toasts made it, nothing to wait for\n";
+        return 1;
     }
-    
-    QString iconPath = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/icons/h.gif";
-    QDir iconDir(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/icons");
-    if (!iconDir.exists()) {
-        iconDir.mkpath(".");
-    }
-    
-    QFile::copy(":/assets/h.gif", iconPath);
-    QFile::setPermissions(iconPath, QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup | QFile::ReadOther);
-    
-    QString desktopFilePath = applicationsPath + "/h.desktop";
-    QFile desktopFile(desktopFilePath);
-    
-    QString executablePath = QCoreApplication::applicationFilePath();
-    
-    if (desktopFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&desktopFile);
-        out << "[Desktop Entry]\n";
-        out << "Type=Application\n";
-        out << "Name=h\n";
-        out << "Comment=h\n";
-        out << "Icon=" << iconPath << "\n";
-        out << "Exec=" << executablePath << " --h\n";
-        out << "Terminal=false\n";
-        out << "Categories=Utility;\n";
-        
-        desktopFile.close();
-        
-        QFile::setPermissions(desktopFilePath, 
-            QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner |
-            QFile::ReadGroup | QFile::ExeGroup |
-            QFile::ReadOther | QFile::ExeOther);
-        
-        std::cout << "h deployed at: " << desktopFilePath.toStdString() << "\n";
-    } else {
-        std::cerr << "failed to h...\n";
+    NotificationEvent event;
+    if (!NotificationEvents::instance().wait(timeout, event)) {
+        std::cerr << "nobody did anything with the toasts\n";
+        return 3;
     }
-}
-
-void setNotificationImageFromResource(NotifyNotification *n, const QString &resourcePath) {
-    QImage image(resourcePath);
-    if (image.isNull()) {
-        std::cerr << "the image is corrupted or not there idfk\n";
-        return;
+    if (event.type == NotificationEventType::Closed) {
+        return 2;
     }
-    
-    image = image.convertToFormat(QImage::Format_RGBA8888);
-    
-    int width = image.width();
-    int height = image.height();
-    int rowstride = image.bytesPerLine();
-    bool hasAlpha = true;
-    int bitsPerSample = 8;
-    int channels = 4;
-    
-    GBytes *bytes = g_bytes_new(image.constBits(), image.sizeInBytes());
-    
-    GVariant *imageData = g_variant_new("(iiibii@ay)",
-        width, height, rowstride, hasAlpha, bitsPerSample, channels,
-        g_variant_new_from_bytes(G_VARIANT_TYPE_BYTESTRING, bytes, TRUE)
-    );
-    
-    notify_notification_set_hint(n, "image-data", imageData);
-    g_bytes_unref(bytes);
-}
-
-// no but seriously why
-static void doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing(NotifyNotification *notification, char *action, gpointer user_data) {
-    std::cout << "ok\n";
+    std::cout << event.action << "\n";
+    return 0;
 }
 
-void sendNotification(const std::string &notificationType) {
-    // unfortunatley libnotify isnt as advanced like windows xaml com object whatever notifications so we have to remove some stuff to make it still work
-
-    static bool initialized = false;
-    if (!initialized) {
-        if (!notify_init("the news")) {
-            std::cerr << "libnotify is not notifying\n";
-            return;
-        }
-        initialized = true;
-    }
-
-    std::string title;
-    std::string message;
-    NotifyNotification *n = nullptr;
-
-    if (notificationType == "someoneDied") {
-        title = "BREAKING NEWS!!!";
-        message = "Someone just died! Who? We don't know.";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-    } else if (notificationType == "donate") {
-        title = "we need your money";
-        message = "donate to \"the news\"\n\n";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        notify_notification_add_action(n, "donate_100k", "100k dollars", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "donate_1k", "1k dollars", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "donate_1", "1 dollar", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "serversDying") {
-        title = "please donate us money";
-        message = "our in house servers ae dying of money :(\n\n";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        notify_notification_set_urgency(n, NOTIFY_URGENCY_CRITICAL);
-        
-        notify_notification_add_action(n, "donate_100k", "100k dollars", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "donate_1k", "1k dollars", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "donate_1", "1 dollar", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "deleteSystem32") {
-        title = "welp";
-        message = "since you didn't donate to the news...\ndeleting system32...\n21/15,245 files";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        notify_notification_set_hint(n, "value", g_variant_new_int32(50));
-        notify_notification_set_hint(n, "synchronous", g_variant_new_string("system32-delete"));
-
-        notify_notification_add_action(n, "cope", "cope ¯\\_(\\ツ)_/¯", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "donate_late", "donate before its late", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-    } else if (notificationType == "incomingCall") {
-        title = "John Phone";
-        message = "Incoming Call - Satellite";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/johnphone.jpg");
-        notify_notification_set_urgency(n, NOTIFY_URGENCY_CRITICAL);
-        notify_notification_set_hint(n, "category", g_variant_new_string("im.received"));
-
-        notify_notification_add_action(n, "answer", "Answer", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "earthOnFire") {
-        title = "BREAKING NEWS! the earth is on fire lmfao";
-        message = "weather forecast:\n\n"
-                  "Mon: ☀️ 63° / 42°\n"
-                  "Tue: ☀️ 78° / 60°\n"
-                  "Wed: ☀️ 96° / 76°\n"
-                  "Thu: ☀️ 132° / 89°\n"
-                  "Fri: ☀️ 244° / 120°";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-    } else if (notificationType == "friendRequest") {
-        title = "John Phone sent you a friend request";
-        message = "i want Sponsorships.";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/johnphone.jpg");
-        notify_notification_add_action(n, "accept", "Accept", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "decline", "Decline", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "websiteRedesign") {
-        title = "we redesigned our website";
-        message = "enjoy it and leave feed back";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/redesign.png");
-        
-        notify_notification_add_action(n, "good", "good", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "horrid", "horrid", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "roadblocks") {
-        title = "BREAKING NEWS!!!";
-        message = "California man posts TikTok of him riding in his golf cart rambling on about 'roadblocks' on the beach, goes crazy fucking viral.";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/roadblocks.gif");
-        
-        notify_notification_add_action(n, "read_more", "Read More", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "discard", "discard", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "linkerTragedy") {
-        title = "BREAKING NEWS!!!";
-        message = "Discord user @linker.sh, from the server 'Face's attic', goes all in on black, loses it all in 1 night - tragedy unfolds.";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/linker.sh.png");
-        
-        notify_notification_add_action(n, "read_more", "Read More", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "discard", "discard", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "mazeGambled") {
-        title = "BREAKING NEWS!!!!!!!!!!!!!!!!!!!!!";
-        message = "MAZE CONCENTRATED ON GAMBLING SO HARD THEY GOT $-1 IN RETURN???";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/maze.png");
-        
-        notify_notification_add_action(n, "read_more", "Read More", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "discard", "discard", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "femboyLabs") {
-        title = "BREAKING NEWS!!!";
-        message = "femboyLabs has rebranded again!";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/astolfo.jpg");
-        
-        notify_notification_add_action(n, "read_more", "Read More", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "discard", "discard", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "bussinIndustries") {
-        title = "BREAKING NEWS!!!";
-        message = "Bussin Industries shares cryptic note on staff channels.\n\nSource: X";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/bussin_industries.png");
-        
-        notify_notification_add_action(n, "read_more", "Read More", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "discard", "discard", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "hTile") {
-        createHDesktopFile();
-        
-        title = "h";
-        message = "check your start menu and enjoy your free h";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/h.gif");
-        
-    } else if (notificationType == "baseballEmoji") {
-        title = "⚾️ Baseball on Discord?! 🤯";
-        message = "Fr fr, a baseball emoji just dropped on Discord. Icl, ts kinda mogging ngl. 🤣";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/whateverthisis.png");
-        
-        notify_notification_add_action(n, "read_more", "Read More", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "discard", "discard", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "jonathanPork") {
-        title = "John Pork";
-        message = "Incoming Call - Satellite";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/johnpork.jpg");
-        notify_notification_set_urgency(n, NOTIFY_URGENCY_CRITICAL);
-        notify_notification_set_hint(n, "category", g_variant_new_string("im.received"));
-
-        notify_notification_add_action(n, "answer", "Answer", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "linkerAgain") {
-        title = "Text message from +1 248-434-5508";
-        message = "We've successfully assassinated the attacker. Thank you for contacting Valve Support.\n\nLinker's Samsung Galaxy";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        notify_notification_add_action(n, "gamble", "Gamble it all away", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "hGif") {
-        title = "h";
-        message = "h";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/h.gif");
-        
-    } else if (notificationType == "findMeOnline") {
-        title = "John Phone";
-        message = "Find me online";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/itsme...johnphone.jpg");
-        
-        notify_notification_add_action(n, "send", "Send", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "googServices") {
-        title = "the news needs Google Play Services";
-        message = "the news uses Google Play Services to provide you a better experience. Install it. Right now. I don't care that you are using a desktop OS. Install it.";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/googleplayservices.png");
-        
-    } else if (notificationType == "flash") {
-        title = "BREAKING NEWS!!!";
-        message = "To view this notification, install Adobe® Flash Player™";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/flashplayer.png");
-        
-    } else if (notificationType == "mcafee") {
-        title = "BREAKING NEWS!!!";
-        message = "Your McAfee™ subscription plan has expired. Please select a new one below.\n\nEssential - $119.99\nMcAfee+™ Premium Individual - $149.99\nMcAfee+™ Advanced Individual - $199.99";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/mcafee.png");
-        
-        notify_notification_add_action(n, "subscribe", "yeah this gud!", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        notify_notification_add_action(n, "cancel", "no never cancel it rn", doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing, nullptr, nullptr);
-        
-    } else if (notificationType == "noskid") {
-        title = "BREAKING NEWS!!!";
-        message = "To view this notification, upload a NoSkid certificate.";
-        
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-        
-        setNotificationImageFromResource(n, ":/assets/noskid.png");
-        
-    } else {
-        title = "no notification :(";
-        message = "notification doesnt exist somehow what did i call to get this...?";
-        n = notify_notification_new(title.c_str(), message.c_str(), nullptr);
-    }
+// calls back once, the first time anything in the app gets a paint event
+class FirstPaintWatcher : public QObject {
+public:
+    explicit FirstPaintWatcher(std::function<void()> callback) : m_callback(std::move(callback)) {}
 
-    GError *error = nullptr;
-    if (!notify_notification_show(n, &error)) {
-        if (error) {
-            std::cerr << "error notifying the notification smh: " << error->message << "\n";
-            g_error_free(error);
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override {
+        if (event->type() == QEvent::Paint && m_callback) {
+            auto callback = std::move(m_callback);
+            m_callback = nullptr;
+            QCoreApplication::instance()->removeEventFilter(this);
+            callback();
         }
+        return QObject::eventFilter(watched, event);
     }
 
-    g_object_unref(G_OBJECT(n));
-}
-
-void printHelp() {
-    std::cout << "the news cli!\n\n";
-    std::cout << "usage: thenews [OPTION]\n\n";
-    std::cout << "options:\n";
-    std::cout << "  --help                show this help message\n";
-    std::cout << "  --h                   show the h\n";
-    std::cout << "  --someoneDied         someone died notification\n";
-    std::cout << "  --donate              donation request\n";
-    std::cout << "  --serversDying        servers dying notification\n";
-    std::cout << "  --deleteSystem32      system32 deletion warning\n";
-    std::cout << "  --incomingCall        John Phone incoming call\n";
-    std::cout << "  --earthOnFire         earth on fire weather forecast\n";
-    std::cout << "  --friendRequest       John Phone friend request\n";
-    std::cout << "  --websiteRedesign     website redesign announcement\n";
-    std::cout << "  --roadblocks          roadblocks viral video\n";
-    std::cout << "  --linkerTragedy       linker gambling tragedy\n";
-    std::cout << "  --mazeGambled         maze gambling story\n";
-    std::cout << "  --femboyLabs          femboyLabs rebrand\n";
-    std::cout << "  --bussinIndustries    Bussin Industries cryptic note\n";
-    std::cout << "  --hTile               put the h in your start menu\n";
-    std::cout << "  --baseballEmoji       baseball emoji on Discord\n";
-    std::cout << "  --jonathanPork        john Pork incoming call\n";
-    std::cout << "  --linkerAgain         linker text message\n";
-    std::cout << "  --hGif                h gif notification\n";
-    std::cout << "  --findMeOnline        find me online\n";
-    std::cout << "  --googServices        Google Play Services request\n";
-    std::cout << "  --flash               Flash Player required\n";
-    std::cout << "  --mcafee              McAfee subscription expired\n";
-    std::cout << "  --noskid              NoSkid certificate required\n";
-    std::cout << "\n";
-    std::cout << "if no option is provided, the news ui will launch\n";
-}
-
-auto addConsistentStyle = [](QPushButton *btn) {
-    QPalette palette = btn->palette();
-    QColor baseColor = palette.color(QPalette::Button);
-    baseColor.setAlpha(100);
-    
-    QColor hoverColor = baseColor.lighter(110);
-    hoverColor.setAlpha(100);
-    
-    QColor pressColor = baseColor.darker(120);
-    pressColor.setAlpha(100);
-    
-    btn->setStyleSheet(
-        QString("QPushButton { "
-                "background-color: rgba(%1, %2, %3, %4); "
-                "color: black; "
-                "border: 1px solid black; "
-                "} "
-                "QPushButton:hover { "
-                "background-color: rgba(%5, %6, %7, %8); "
-                "} "
-                "QPushButton:pressed { "
-                "background-color: rgba(%9, %10, %11, %12); "
-                "}")
-            .arg(baseColor.red()).arg(baseColor.green()).arg(baseColor.blue()).arg(baseColor.alpha())
-            .arg(hoverColor.red()).arg(hoverColor.green()).arg(hoverColor.blue()).arg(hoverColor.alpha())
-            .arg(pressColor.red()).arg(pressColor.green()).arg(pressColor.blue()).arg(pressColor.alpha())
-    );
+private:
+    std::function<void()> m_callback;
 };
 
-
 int main(int argc, char *argv[]) {
+    StartupProfile profile;
+
     // Check for CLI arguments
-    bool cliMode = false;
-    std::string notification = "";
+    bool showStats = false;
+    long statsInterval = 0;
+    std::string metricsSocket;
+    bool startupProfile = false;
+    std::string assetPack;
+    bool useAssetPack = true;
+    DispatchPolicy dispatchPolicy = DispatchPolicy::DropOldest;
+    std::size_t dispatchQueue = 64;
+    double maxToastRate = 0;
+    AutoToastPlaylist playlist = AutoToastPlaylist::Classic;
+    BatchOptions batch;
+    bool batchMode = false;
+    bool daemonMode = false;
+    bool waitMode = false;
+    std::chrono::seconds waitTimeout{0};
+    std::vector<std::string> daemonSends;
+    std::string socketPath;
     
     for (int i = 1; i < argc; i++) {
-        std::string arg = argv[i];
+        std::string_view arg = argv[i];
         if (arg == "--help") {
             printHelp();
             return 0;
-        } else if (arg == "--h") {
-            cliMode = true;
-            notification = "hGif";
-        } else if (arg == "--someoneDied") {
-            cliMode = true;
-            notification = "someoneDied";
-        } else if (arg == "--donate") {
-            cliMode = true;
-            notification = "donate";
-        } else if (arg == "--serversDying") {
-            cliMode = true;
-            notification = "serversDying";
-        } else if (arg == "--deleteSystem32") {
-            cliMode = true;
-            notification = "deleteSystem32";
-        } else if (arg == "--incomingCall") {
-            cliMode = true;
-            notification = "incomingCall";
-        } else if (arg == "--earthOnFire") {
-            cliMode = true;
-            notification = "earthOnFire";
-        } else if (arg == "--friendRequest") {
-            cliMode = true;
-            notification = "friendRequest";
-        } else if (arg == "--websiteRedesign") {
-            cliMode = true;
-            notification = "websiteRedesign";
-        } else if (arg == "--roadblocks") {
-            cliMode = true;
-            notification = "roadblocks";
-        } else if (arg == "--linkerTragedy") {
-            cliMode = true;
-            notification = "linkerTragedy";
-        } else if (arg == "--mazeGambled") {
-            cliMode = true;
-            notification = "mazeGambled";
-        } else if (arg == "--femboyLabs") {
-            cliMode = true;
-            notification = "femboyLabs";
-        } else if (arg == "--bussinIndustries") {
-            cliMode = true;
-            notification = "bussinIndustries";
-        } else if (arg == "--hTile") {
-            cliMode = true;
-            notification = "hTile";
-        } else if (arg == "--baseballEmoji") {
-            cliMode = true;
-            notification = "baseballEmoji";
-        } else if (arg == "--jonathanPork") {
-            cliMode = true;
-            notification = "jonathanPork";
-        } else if (arg == "--linkerAgain") {
-            cliMode = true;
-            notification = "linkerAgain";
-        } else if (arg == "--hGif") {
-            cliMode = true;
-            notification = "hGif";
-        } else if (arg == "--findMeOnline") {
-            cliMode = true;
-            notification = "findMeOnline";
-        } else if (arg == "--googServices") {
-            cliMode = true;
-            notification = "googServices";
-        } else if (arg == "--flash") {
-            cliMode = true;
-            notification = "flash";
-        } else if (arg == "--mcafee") {
-            cliMode = true;
-            notification = "mcafee";
-        } else if (arg == "--noskid") {
-            cliMode = true;
-            notification = "noskid";
+        } else if (arg == "--stats") {
+            showStats = true;
+        } else if (arg == "--stats-interval" && i + 1 < argc) {
+            statsInterval = std::strtol(argv[++i], nullptr, 10);
+        } else if (arg == "--metrics-socket" && i + 1 < argc) {
+            metricsSocket = argv[++i];
+        } else if (arg == "--startup-profile") {
+            startupProfile = true;
+        } else if (arg == "--image-cache-mb" && i + 1 < argc) {
+            ImageCache::instance().setCapacity(std::strtoull(argv[++i], nullptr, 10) * 1024 * 1024);
+        } else if (arg == "--image-max-size" && i + 1 < argc) {
+            ImageCache::instance().setMaxDimension(std::atoi(argv[++i]));
+        } else if (arg == "--asset-pack" && i + 1 < argc) {
+            assetPack = argv[++i];
+        } else if (arg == "--no-asset-pack") {
+            useAssetPack = false;
+        } else if (arg == "--image-path") {
+            setNotificationImageMode(NotificationImageMode::Path);
+        } else if (arg == "--animate") {
+            setNotificationAnimation(true);
+        } else if (arg == "--animation-cpu" && i + 1 < argc) {
+            NotificationAnimator::instance().setCpuBudget(std::strtod(argv[++i], nullptr) / 100);
+        } else if (arg == "--animation-seconds" && i + 1 < argc) {
+            NotificationAnimator::instance().setMaxDuration(std::chrono::seconds(std::strtoll(argv[++i], nullptr, 10)));
+        } else if (arg == "--image-rgba") {
+            ImageCache::instance().setPackOpaqueAsRgb(false);
+        } else if (arg == "--dispatch-policy" && i + 1 < argc) {
+            if (!parseDispatchPolicy(argv[++i], dispatchPolicy)) {
+                std::cerr << "unknown dispatch policy " << argv[i] << ", its drop-oldest, coalesce or block\n";
+                return 1;
+            }
+        } else if (arg == "--dispatch-queue" && i + 1 < argc) {
+            dispatchQueue = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--max-toast-rate" && i + 1 < argc) {
+            maxToastRate = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--playlist" && i + 1 < argc) {
+            if (!parseAutoToastPlaylist(argv[++i], playlist)) {
+                std::cerr << "unknown playlist " << argv[i] << ", its classic, sequential, random or weighted\n";
+                return 1;
+            }
+        } else if (arg == "--backend" && i + 1 < argc) {
+            std::string_view name = argv[++i];
+            if (name == "libnotify") {
+                setNotificationBackend(NotificationBackend::Libnotify);
+            } else if (name == "gdbus") {
+                setNotificationBackend(NotificationBackend::GDBus);
+            } else {
+                std::cerr << "unknown backend " << name << ", its libnotify or gdbus\n";
+                return 1;
+            }
+        } else if (arg == "--dbus-window" && i + 1 < argc) {
+            DBusNotifier::instance().setWindow(std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--replace-toasts") {
+            setNotificationReuse(NotificationReuse::Replace);
+        } else if (arg == "--wait") {
+            waitMode = true;
+        } else if (arg == "--wait-timeout" && i + 1 < argc) {
+            waitTimeout = std::chrono::seconds(std::strtoll(argv[++i], nullptr, 10));
+        } else if (arg == "--daemon") {
+            daemonMode = true;
+        } else if (arg == "--send" && i + 1 < argc) {
+            daemonSends.emplace_back(argv[++i]);
+        } else if (arg == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            batch.repeat = std::strtoull(argv[++i], nullptr, 10);
+            batchMode = true;
+        } else if (arg == "--interval" && i + 1 < argc) {
+            batch.interval = std::chrono::milliseconds(std::strtoll(argv[++i], nullptr, 10));
+        } else if (arg == "--list" && i + 1 < argc) {
+            batch.lists.emplace_back(argv[++i]);
+            batchMode = true;
+        } else if (arg.substr(0, 2) == "--") {
+            NotificationId notification;
+            if (findNotification(arg.substr(2), notification)) {
+                batch.notifications.push_back(notification);
+            }
         }
     }
-    
-    // CLI mode - send notification and exit without showing GUI
-    if (cliMode) {
-        QCoreApplication coreApp(argc, argv);
-        sendNotification(notification);
-        return 0;
+    batchMode = batchMode || batch.notifications.size() > 1;
+
+    // a missing pack next to the executable just means decoding from the
+    // resources like before, one that was asked for by name has to be there
+    if (useAssetPack && daemonSends.empty()) {
+        std::string error;
+        if (!AssetPack::instance().open(assetPack.empty() ? AssetPack::defaultPath() : assetPack, &error) && !assetPack.empty()) {
+            std::cerr << error << "\n";
+            return 1;
+        }
     }
-    
-    // GUI mode
-    QApplication app(argc, argv);
-
-    int fontId = QFontDatabase::addApplicationFont(":/assets/nimbusroman.otf");
-    QString family;
-    if (fontId != -1) {
-        family = QFontDatabase::applicationFontFamilies(fontId).at(0);
+    if (socketPath.empty()) {
+        socketPath = defaultControlSocketPath();
     }
 
-    QMainWindow window;
-    window.setWindowIcon(QIcon(":/assets/thenews.png"));
-    window.setWindowTitle("the news");
-    
-    QStackedWidget *stackedWidget = new QStackedWidget();
-    
-    // page 1!
-    QMainWindow *page1Window = new QMainWindow();
-    Ui_MainWindow ui;
-    ui.setupUi(page1Window);
-    stackedWidget->addWidget(page1Window);
-    
-    // ok now we stack page 2 on it
-    QMainWindow *page2Window = new QMainWindow();
-    Ui_Page2Window page2Ui;
-    page2Ui.setupUi(page2Window);
-    stackedWidget->addWidget(page2Window);
-    
-    window.setCentralWidget(stackedWidget);
-
-    auto replaceWithSkewed = [](QPushButton *original, double skewX, double skewY, double translateX, double translateY, double rotation) -> SkewedButton* {
-        SkewedButton *skewed = new SkewedButton(original->parentWidget());
-        skewed->setGeometry(original->geometry());
-        skewed->setText(original->text());
-        skewed->setPalette(original->palette());
-        skewed->setSkewTransform(skewX, skewY, translateX, translateY, rotation);
-        
-        original->hide();
-        return skewed;
-    };
-
-    auto skewedDonation = replaceWithSkewed(ui.donation, 0, 29.612, -11.22, 18.454, 31.3);
-    QObject::connect(skewedDonation, &QPushButton::clicked, []() {
-        sendNotification("donate");
-    });
-
-    auto skewedSysem32 = replaceWithSkewed(ui.sysem32, 0, 13.325, 0, 8.763, 0);
-    QObject::connect(skewedSysem32, &QPushButton::clicked, []() {
-        sendNotification("deleteSystem32");
-    });
-
-    auto skewedJohnPhone = replaceWithSkewed(ui.johnPhone, -30.472, 0, -52.662, 0, 0);
-    QObject::connect(skewedJohnPhone, &QPushButton::clicked, []() {
-        sendNotification("incomingCall");
-    });
-
-    auto skewedJohnPhoneFQ = replaceWithSkewed(ui.johnPhoneFQ, -16.861, 0, 5.796, 0, 0);
-    QObject::connect(skewedJohnPhoneFQ, &QPushButton::clicked, []() {
-        sendNotification("friendRequest");
-    });
-
-    auto skewedRoadblocks = replaceWithSkewed(ui.roadblocks, 0, 8.005, 0, 4.359, 0);
-    QObject::connect(skewedRoadblocks, &QPushButton::clicked, []() {
-        sendNotification("roadblocks");
-    });
-
-    auto skewedMazeGambled = replaceWithSkewed(page2Ui.mazeGambled, -45, 0, 16, 0, 0);
-    QObject::connect(skewedMazeGambled, &QPushButton::clicked, []() {
-        sendNotification("mazeGambled");
-    });
-
-    auto skewedFemboyLabs = replaceWithSkewed(page2Ui.femboyLabs, 31.997, 0, -9.375, 2.713, -16.137);
-    QObject::connect(skewedFemboyLabs, &QPushButton::clicked, []() {
-        sendNotification("femboyLabs");
-    });
+    // client for the daemon, no qt or libnotify needed for this
+    if (!daemonSends.empty()) {
+        std::string error;
+        if (!sendToDaemon(socketPath, daemonSends, error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        return 0;
+    }
 
-    auto skewedBaseballEmoji = replaceWithSkewed(page2Ui.baseballEmoji, -61.557, 0, -6.784, 0, 0);
-    QObject::connect(skewedBaseballEmoji, &QPushButton::clicked, []() {
-        sendNotification("baseballEmoji");
-    });
+    // runs on its own thread, so its the same for the daemon, the cli and the ui
+    MetricsExporter metrics;
+    if (!metricsSocket.empty()) {
+        std::string error;
+        if (!metrics.listen(metricsSocket, error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+    }
+    metrics.setLogInterval(std::chrono::seconds(statsInterval));
+    metrics.start();
 
-    auto skewedLinkerAgain = replaceWithSkewed(page2Ui.linkerAgain, -19.44, 0, 5.647, 0, 0);
-    QObject::connect(skewedLinkerAgain, &QPushButton::clicked, []() {
-        sendNotification("linkerAgain");
-    });
+    if (daemonMode) {
+        return runDaemon(argc, argv, socketPath, dispatchPolicy, dispatchQueue);
+    }
 
-    auto addHoverEffect = [](QPushButton *btn) {
-        btn->setStyleSheet(
-            "QPushButton { background-color: rgba(116, 125, 136, 100); color: black; }"
-            "QPushButton:hover { background-color: rgba(130, 140, 150, 100); }"
-            "QPushButton:pressed { background-color: rgba(100, 110, 120, 100); }"
-        );
-    };
+    // has to be listening before the first toast goes out or a quick click is
+    // gone. --list and --repeat send from the cli too, not just named toasts
+    if (waitMode && (batchMode || !batch.notifications.empty())) {
+        std::string error;
+        if (!NotificationEvents::instance().start(&error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+    }
     
-    // page 1
-    addHoverEffect(ui.someoneDied);
-    addHoverEffect(ui.alarm);
-    addHoverEffect(ui.weather);
-    addHoverEffect(ui.redesign);
-    addHoverEffect(ui.linkie);
-    addHoverEffect(ui.page2);
-
-    QObject::connect(ui.someoneDied, &QPushButton::clicked, []() {
-        sendNotification("someoneDied");
-    });
-
-    QObject::connect(ui.alarm, &QPushButton::clicked, []() {
-        sendNotification("serversDying");
-    });
-
-    QObject::connect(ui.weather, &QPushButton::clicked, []() {
-        sendNotification("earthOnFire");
-    });
-
-    QObject::connect(ui.redesign, &QPushButton::clicked, []() {
-        sendNotification("websiteRedesign");
-    });
-
-    QObject::connect(ui.linkie, &QPushButton::clicked, []() {
-        sendNotification("linkerTragedy");
-    });
-
-    QObject::connect(ui.page2, &QPushButton::clicked, [stackedWidget]() {
-        stackedWidget->setCurrentIndex(1);
-    });
-
-    // page 2
-
-    addHoverEffect(page2Ui.bussinIndustries);
-    addHoverEffect(page2Ui.hTile);
-    addHoverEffect(page2Ui.jonathanPork);
-    addHoverEffect(page2Ui.hGif);
-    addHoverEffect(page2Ui.findMeOnline);
-    addHoverEffect(page2Ui.googServices);
-    addHoverEffect(page2Ui.flash);
-    addHoverEffect(page2Ui.coffee);
-    addHoverEffect(page2Ui.noskid);
-    addHoverEffect(page2Ui.backButton);
-
-    QObject::connect(page2Ui.bussinIndustries, &QPushButton::clicked, []() {
-        sendNotification("bussinIndustries");
-    });
-
-    QObject::connect(page2Ui.hTile, &QPushButton::clicked, []() {
-        sendNotification("hTile");
-    });
-
-    QObject::connect(page2Ui.jonathanPork, &QPushButton::clicked, []() {
-        sendNotification("jonathanPork");
-    });
-
-    QObject::connect(page2Ui.hGif, &QPushButton::clicked, []() {
-        sendNotification("hGif");
-    });
-
-    QObject::connect(page2Ui.findMeOnline, &QPushButton::clicked, []() {
-        sendNotification("findMeOnline");
-    });
-
-    QObject::connect(page2Ui.googServices, &QPushButton::clicked, []() {
-        sendNotification("googServices");
-    });
-
-    QObject::connect(page2Ui.flash, &QPushButton::clicked, []() {
-        sendNotification("flash");
-    });
-
-    QObject::connect(page2Ui.coffee, &QPushButton::clicked, []() {
-        sendNotification("mcafee");
-    });
-
-    QObject::connect(page2Ui.noskid, &QPushButton::clicked, []() {
-        sendNotification("noskid");
-    });
-
-    QObject::connect(page2Ui.linkerAgain, &QPushButton::clicked, []() {
-        sendNotification("linkerAgain");
-    });
-
-    QObject::connect(page2Ui.baseballEmoji, &QPushButton::clicked, []() {
-        sendNotification("baseballEmoji");
-    });
-
-    QObject::connect(page2Ui.mazeGambled, &QPushButton::clicked, []() {
-        sendNotification("mazeGambled");
-    });
-
-    QObject::connect(page2Ui.femboyLabs, &QPushButton::clicked, []() {
-        sendNotification("femboyLabs");
-    });
-
-    QObject::connect(page2Ui.backButton, &QPushButton::clicked, [stackedWidget]() {
-        stackedWidget->setCurrentIndex(0);
-    });
-
-
-    if (!family.isEmpty()) {
-        QFont customFont(family);
-        customFont.setPixelSize(36);
-        customFont.setItalic(true);
-        ui.welcomeTheNews->setFont(customFont);
-        ui.donation->setFont(customFont);
+    // CLI mode - send notifications and exit without showing GUI
+    if (batchMode) {
+        QCoreApplication coreApp(argc, argv);
+        BatchSummary summary;
+        if (!runBatch(batch, summary)) {
+            return 1;
+        }
+        // the process going away would freeze them on whatever frame they were at
+        if (notificationAnimation()) {
+            NotificationAnimator::instance().wait();
+        }
+        // gdbus toasts count as sent when they go out, the errors come back later
+        std::uint64_t lateFailures = 0;
+        if (notificationBackend() == NotificationBackend::GDBus) {
+            DBusNotifier::instance().wait();
+            lateFailures = DBusNotifier::instance().stats().failed;
+        }
+        int waited = waitMode ? waitForToasts(waitTimeout) : 0;
+        if (showStats) {
+            printStats();
+        }
+        return summary.failed + lateFailures > 0 ? 1 : waited;
+    } else if (!batch.notifications.empty()) {
+        QCoreApplication coreApp(argc, argv);
+        sendNotification(batch.notifications.front());
+        if (notificationAnimation()) {
+            NotificationAnimator::instance().wait();
+        }
+        if (notificationBackend() == NotificationBackend::GDBus) {
+            DBusNotifier::instance().wait();
+        }
+        int waited = waitMode ? waitForToasts(waitTimeout) : 0;
+        if (showStats) {
+            printStats();
+        }
+        return waited;
     }
+    
+    // GUI mode
+    QApplication app(argc, argv);
+    profile.mark("QApplication ctor");
 
-    // page 1
-    addConsistentStyle(ui.someoneDied);
-    addConsistentStyle(ui.alarm);
-    addConsistentStyle(ui.weather);
-    addConsistentStyle(ui.redesign);
-    addConsistentStyle(ui.linkie);
-    addConsistentStyle(ui.page2);
-
-    // page 2
-    addConsistentStyle(page2Ui.bussinIndustries);
-    addConsistentStyle(page2Ui.hTile);
-    addConsistentStyle(page2Ui.jonathanPork);
-    addConsistentStyle(page2Ui.hGif);
-    addConsistentStyle(page2Ui.findMeOnline);
-    addConsistentStyle(page2Ui.googServices);
-    addConsistentStyle(page2Ui.flash);
-    addConsistentStyle(page2Ui.coffee);
-    addConsistentStyle(page2Ui.noskid);
-    addConsistentStyle(page2Ui.backButton);
-
-    // auto toast from page 1
-    QTimer *autoToastTimer = new QTimer();
-    int currentToastIndex = 0;
-    bool isAutoToastRunning = false;
-
-    QPushButton *autoToastButton = new QPushButton("Start Auto Toast");
-    autoToastButton->setGeometry(623, 76, 182, 293);
-    autoToastButton->setParent(page1Window->centralWidget());
-    addHoverEffect(autoToastButton);
-    addConsistentStyle(autoToastButton);
-
-    QWidget *intervalContainer = new QWidget(page1Window->centralWidget());
-    intervalContainer->setGeometry(389, 343, 400, 100);
-
-    QHBoxLayout *intervalLayout = new QHBoxLayout(intervalContainer);
-    intervalLayout->setContentsMargins(0, 0, 0, 0);
-
-    QLabel *intervalTextLabel = new QLabel("Toast Interval:");
-    intervalLayout->addWidget(intervalTextLabel);
-
-    QSlider *intervalSlider = new QSlider(Qt::Horizontal);
-    intervalSlider->setMinimum(0);
-    intervalSlider->setMaximum(5000);
-    intervalSlider->setValue(100);
-    intervalSlider->setFixedWidth(200);
-    intervalLayout->addWidget(intervalSlider);
+    // every toast from the ui goes through here so a slow notification
+    // daemon doesnt freeze the window
+    NotificationDispatcher dispatcher(dispatchQueue, dispatchPolicy);
+    profile.mark("dispatcher");
 
-    QLabel *intervalValueLabel = new QLabel("Interval: 100ms");
-    intervalLayout->addWidget(intervalValueLabel);
+    NewsWindow window(dispatcher, profile);
+    window.autoToast().setRateLimit(maxToastRate);
+    window.setPlaylist(playlist);
 
-    QObject::connect(intervalSlider, &QSlider::valueChanged, [intervalValueLabel, autoToastTimer, &isAutoToastRunning](int value) {
-        intervalValueLabel->setText(QString("Interval: %1ms").arg(value));
-        if (isAutoToastRunning && autoToastTimer->isActive()) {
-            autoToastTimer->stop();
-            autoToastTimer->setInterval(value);
-            autoToastTimer->start();
+    dispatcher.setCallback(&app, [&window](const DispatchResult &result) {
+        if (!result.ok) {
+            std::cerr << result.error << "\n";
         }
+        window.autoToast().recordResult(result);
     });
 
-    QObject::connect(autoToastTimer, &QTimer::timeout, [&currentToastIndex]() {
-        switch(currentToastIndex) {
-            case 0: sendNotification("someoneDied"); break;
-            case 1: sendNotification("donate"); break;
-            case 2: sendNotification("serversDying"); break;
-            case 3: sendNotification("deleteSystem32"); break;
-            case 4: sendNotification("incomingCall"); break;
-            case 5: sendNotification("earthOnFire"); break;
-            case 6: sendNotification("friendRequest"); break;
-            case 7: sendNotification("websiteRedesign"); break;
-            case 8: sendNotification("roadblocks"); break;
-            case 9: sendNotification("linkerTragedy"); break;
+    // actions clicked on our toasts, handed to this thread by NotificationEvents
+    NotificationEvents::instance().setCallback(&app, [](const NotificationEvent &event) {
+        if (event.type == NotificationEventType::Action && event.id != NotificationId::Count) {
+            std::cout << notificationDescriptor(event.id).key << ": " << event.action << "\n";
         }
-        currentToastIndex = (currentToastIndex + 1) % 10;
     });
 
-    QObject::connect(autoToastButton, &QPushButton::clicked, [autoToastButton, autoToastTimer, intervalSlider, &isAutoToastRunning, &currentToastIndex]() {
-        if (!isAutoToastRunning) {
-            isAutoToastRunning = true;
-            currentToastIndex = 0;
-            autoToastTimer->setInterval(intervalSlider->value());
-            autoToastTimer->start();
-            autoToastButton->setText("Stop Auto Toast");
-        } else {
-            isAutoToastRunning = false;
-            autoToastTimer->stop();
-            autoToastButton->setText("Start Auto Toast");
-        }
-    });
+    // the font isnt needed for the first frame, so it gets registered right
+    // after the window has painted once
+    FirstPaintWatcher firstPaint([&window, &profile, startupProfile]() {
+        profile.mark("first paint");
+        QTimer::singleShot(0, &window, [&window, &profile, startupProfile]() {
+            int fontId = QFontDatabase::addApplicationFont(resourcePath(ResourceId::NimbusromanOtf));
+            if (fontId != -1) {
+                window.setTitleFont(QFontDatabase::applicationFontFamilies(fontId).at(0));
+            }
+            profile.mark("font");
+            // toasts sent before this dont get heard back from, theres no
+            // button to send one before the window is up anyway
+            std::string error;
+            if (!NotificationEvents::instance().start(&error)) {
+                std::cerr << error << "\n";
+            }
+            profile.mark("notification events");
+            if (startupProfile) {
+                profile.print(std::cout);
+            }
+        });
+    });
+    app.installEventFilter(&firstPaint);
 
     window.show();
-    return app.exec();
-}
\ No newline at end of file
+    profile.mark("window shown");
+
+    int result = app.exec();
+    // its thread outlives app
+    NotificationEvents::instance().setCallback(nullptr, nullptr);
+    if (showStats) {
+        printStats(&dispatcher);
+    }
+    return result;
+}
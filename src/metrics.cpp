@@ -0,0 +1,483 @@
+#include "metrics.h"
+
+#include <glib-unix.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "dispatcher.h"
+#include "imagecache.h"
+#include "notifications.h"
+
+void LatencyHistogram::record(std::chrono::steady_clock::duration duration) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    std::uint64_t value = us > 0 ? static_cast<std::uint64_t>(us) : 0;
+    std::size_t bucket = 0;
+    while (bucket < bounds.size() && value > bounds[bucket]) {
+        bucket++;
+    }
+    buckets[bucket]++;
+    count++;
+    sumUs += value;
+}
+
+std::uint64_t LatencyHistogram::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(count - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bounds.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return bounds[i];
+        }
+    }
+    // in the +Inf bucket, the mean is the best guess we have left
+    return sumUs / count > bounds.back() ? sumUs / count : bounds.back();
+}
+
+NotificationMetrics &NotificationMetrics::instance() {
+    static NotificationMetrics metrics;
+    return metrics;
+}
+
+void NotificationMetrics::recordSend(NotificationId id, bool ok, std::chrono::steady_clock::duration prepare,
+                                     std::chrono::steady_clock::duration show) {
+    std::size_t index = static_cast<std::size_t>(id) < notificationCount ? static_cast<std::size_t>(id) : notificationCount;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    NotificationTypeMetrics &type = m_types[index];
+    if (ok) {
+        type.sent++;
+    } else {
+        type.failed++;
+    }
+    type.prepare.record(prepare);
+    type.show.record(show);
+}
+
+void NotificationMetrics::recordError(const char *domain, int code) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_errors[{domain, code}]++;
+}
+
+void NotificationMetrics::recordError(const GError *error) {
+    if (error) {
+        recordError(g_quark_to_string(error->domain), error->code);
+    } else {
+        recordError("unknown", 0);
+    }
+}
+
+void NotificationMetrics::recordQueueWait(std::chrono::steady_clock::duration waited) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queueWait.record(waited);
+}
+
+void NotificationMetrics::recordEvent(bool action) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (action) {
+        m_actions++;
+    } else {
+        m_closed++;
+    }
+}
+
+void NotificationMetrics::recordEventDelivery(std::chrono::steady_clock::duration delivery) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_eventDelivery.record(delivery);
+}
+
+void NotificationMetrics::addDispatcher(const NotificationDispatcher *dispatcher) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dispatchers.push_back(dispatcher);
+}
+
+void NotificationMetrics::removeDispatcher(const NotificationDispatcher *dispatcher) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_dispatchers.begin(); it != m_dispatchers.end(); ++it) {
+        if (*it == dispatcher) {
+            m_dispatchers.erase(it);
+            return;
+        }
+    }
+}
+
+NotificationTypeMetrics NotificationMetrics::type(NotificationId id) const {
+    std::size_t index = static_cast<std::size_t>(id) < notificationCount ? static_cast<std::size_t>(id) : notificationCount;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_types[index];
+}
+
+static void add(LatencyHistogram &to, const LatencyHistogram &from) {
+    for (std::size_t i = 0; i < to.buckets.size(); i++) {
+        to.buckets[i] += from.buckets[i];
+    }
+    to.count += from.count;
+    to.sumUs += from.sumUs;
+}
+
+NotificationTypeMetrics NotificationMetrics::total() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    NotificationTypeMetrics total;
+    for (const auto &type : m_types) {
+        total.sent += type.sent;
+        total.failed += type.failed;
+        add(total.prepare, type.prepare);
+        add(total.show, type.show);
+    }
+    return total;
+}
+
+std::map<std::pair<std::string, int>, std::uint64_t> NotificationMetrics::errors() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_errors;
+}
+
+static std::string formatUs(std::uint64_t us) {
+    char buffer[32];
+    if (us < 1000) {
+        std::snprintf(buffer, sizeof(buffer), "%lluus", static_cast<unsigned long long>(us));
+    } else if (us < 1000000) {
+        std::snprintf(buffer, sizeof(buffer), "%.1fms", static_cast<double>(us) / 1000);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.2fs", static_cast<double>(us) / 1000000);
+    }
+    return buffer;
+}
+
+static const char *typeName(std::size_t index) {
+    return index < notificationCount ? notificationCatalog[index].key.data() : "unknown";
+}
+
+void NotificationMetrics::print(std::ostream &out) const {
+    NotificationTypeMetrics all = total();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    out << "notifications: " << all.sent << " sent, " << all.failed << " failed, prepare p50 "
+        << formatUs(all.prepare.percentile(0.5)) << " p99 " << formatUs(all.prepare.percentile(0.99)) << ", show p50 "
+        << formatUs(all.show.percentile(0.5)) << " p99 " << formatUs(all.show.percentile(0.99)) << "\n";
+    for (std::size_t i = 0; i < m_types.size(); i++) {
+        const NotificationTypeMetrics &type = m_types[i];
+        if (type.sent + type.failed == 0) {
+            continue;
+        }
+        char line[160];
+        std::snprintf(line, sizeof(line), "  %-20s %6llu sent %4llu failed   prepare %7s/%-7s show %7s/%-7s\n", typeName(i),
+                      static_cast<unsigned long long>(type.sent), static_cast<unsigned long long>(type.failed),
+                      formatUs(type.prepare.percentile(0.5)).c_str(), formatUs(type.prepare.percentile(0.99)).c_str(),
+                      formatUs(type.show.percentile(0.5)).c_str(), formatUs(type.show.percentile(0.99)).c_str());
+        out << line;
+    }
+    for (const auto &error : m_errors) {
+        out << "  error " << error.first.first << " " << error.first.second << ": " << error.second << "\n";
+    }
+    if (m_queueWait.count) {
+        out << "queue wait: p50 " << formatUs(m_queueWait.percentile(0.5)) << " p99 " << formatUs(m_queueWait.percentile(0.99))
+            << " over " << m_queueWait.count << " toasts\n";
+    }
+    if (m_actions + m_closed) {
+        out << "events: " << m_actions << " actions, " << m_closed << " closed, delivered p50 "
+            << formatUs(m_eventDelivery.percentile(0.5)) << " p99 " << formatUs(m_eventDelivery.percentile(0.99)) << "\n";
+    }
+}
+
+std::string NotificationMetrics::summary() const {
+    NotificationTypeMetrics all = total();
+    std::ostringstream out;
+    out << all.sent << " sent, " << all.failed << " failed, prepare p50 " << formatUs(all.prepare.percentile(0.5))
+        << " p99 " << formatUs(all.prepare.percentile(0.99)) << ", show p50 " << formatUs(all.show.percentile(0.5))
+        << " p99 " << formatUs(all.show.percentile(0.99));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const NotificationDispatcher *dispatcher : m_dispatchers) {
+        DispatchStats dispatch = dispatcher->stats();
+        out << ", queue " << dispatch.depth << "/" << dispatch.capacity;
+    }
+    return out.str();
+}
+
+// label values can have quotes and backslashes in them, domains could
+static std::string escapeLabel(const std::string &value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+static void writeHistogram(std::ostream &out, const char *name, const std::string &labels, const LatencyHistogram &histogram) {
+    std::string prefix = labels.empty() ? "{" : "{" + labels + ",";
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < LatencyHistogram::bounds.size(); i++) {
+        cumulative += histogram.buckets[i];
+        out << name << "_bucket" << prefix << "le=\"" << static_cast<double>(LatencyHistogram::bounds[i]) / 1e6 << "\"} "
+            << cumulative << "\n";
+    }
+    out << name << "_bucket" << prefix << "le=\"+Inf\"} " << histogram.count << "\n";
+    std::string suffix = labels.empty() ? "" : "{" + labels + "}";
+    out << name << "_sum" << suffix << " " << static_cast<double>(histogram.sumUs) / 1e6 << "\n";
+    out << name << "_count" << suffix << " " << histogram.count << "\n";
+}
+
+static void writeHeader(std::ostream &out, const char *name, const char *type, const char *help) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+std::string NotificationMetrics::prometheus() const {
+    ImageCacheStats cache = ImageCache::instance().stats();
+    NotificationPoolStats pool = notificationPoolStats();
+
+    std::ostringstream out;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    writeHeader(out, "thenews_notifications_sent_total", "counter", "Notifications the server took.");
+    for (std::size_t i = 0; i < m_types.size(); i++) {
+        out << "thenews_notifications_sent_total{type=\"" << typeName(i) << "\"} " << m_types[i].sent << "\n";
+    }
+    writeHeader(out, "thenews_notifications_failed_total", "counter", "Notifications that didnt make it.");
+    for (std::size_t i = 0; i < m_types.size(); i++) {
+        out << "thenews_notifications_failed_total{type=\"" << typeName(i) << "\"} " << m_types[i].failed << "\n";
+    }
+
+    // the histograms only for types that were ever sent, 17 lines each adds up
+    writeHeader(out, "thenews_notification_prepare_seconds", "histogram", "Time spent building a notification and its image hints.");
+    for (std::size_t i = 0; i < m_types.size(); i++) {
+        if (m_types[i].prepare.count) {
+            writeHistogram(out, "thenews_notification_prepare_seconds", std::string("type=\"") + typeName(i) + "\"", m_types[i].prepare);
+        }
+    }
+    writeHeader(out, "thenews_notification_show_seconds", "histogram", "Time spent in notify_notification_show.");
+    for (std::size_t i = 0; i < m_types.size(); i++) {
+        if (m_types[i].show.count) {
+            writeHistogram(out, "thenews_notification_show_seconds", std::string("type=\"") + typeName(i) + "\"", m_types[i].show);
+        }
+    }
+
+    writeHeader(out, "thenews_notification_errors_total", "counter", "Failed sends by GError domain and code.");
+    for (const auto &error : m_errors) {
+        out << "thenews_notification_errors_total{domain=\"" << escapeLabel(error.first.first) << "\",code=\""
+            << error.first.second << "\"} " << error.second << "\n";
+    }
+
+    writeHeader(out, "thenews_dispatch_queue_wait_seconds", "histogram", "Time toasts spent queued in a dispatcher.");
+    writeHistogram(out, "thenews_dispatch_queue_wait_seconds", "", m_queueWait);
+
+    writeHeader(out, "thenews_notification_actions_total", "counter", "Actions clicked on toasts we sent.");
+    out << "thenews_notification_actions_total " << m_actions << "\n";
+    writeHeader(out, "thenews_notification_closed_total", "counter", "Toasts we sent that went away.");
+    out << "thenews_notification_closed_total " << m_closed << "\n";
+    writeHeader(out, "thenews_notification_event_delivery_seconds", "histogram", "Time from an action or close signal to its handler.");
+    writeHistogram(out, "thenews_notification_event_delivery_seconds", "", m_eventDelivery);
+
+    std::vector<DispatchStats> dispatch;
+    for (const NotificationDispatcher *dispatcher : m_dispatchers) {
+        dispatch.push_back(dispatcher->stats());
+    }
+    writeHeader(out, "thenews_dispatch_queue_depth", "gauge", "Toasts waiting in a dispatcher lane.");
+    for (std::size_t i = 0; i < dispatch.size(); i++) {
+        for (std::size_t lane = 0; lane < dispatchLaneCount; lane++) {
+            out << "thenews_dispatch_queue_depth{dispatcher=\"" << i << "\",lane=\"" << dispatchLaneName(static_cast<DispatchLane>(lane))
+                << "\"} " << dispatch[i].lanes[lane].depth << "\n";
+        }
+    }
+    writeHeader(out, "thenews_dispatch_queue_capacity", "gauge", "How many toasts each dispatcher lane lets pile up.");
+    for (std::size_t i = 0; i < dispatch.size(); i++) {
+        out << "thenews_dispatch_queue_capacity{dispatcher=\"" << i << "\"} " << dispatch[i].capacity << "\n";
+    }
+    writeHeader(out, "thenews_dispatch_dropped_total", "counter", "Toasts thrown out of a full lane.");
+    for (std::size_t i = 0; i < dispatch.size(); i++) {
+        for (std::size_t lane = 0; lane < dispatchLaneCount; lane++) {
+            out << "thenews_dispatch_dropped_total{dispatcher=\"" << i << "\",lane=\"" << dispatchLaneName(static_cast<DispatchLane>(lane))
+                << "\"} " << dispatch[i].lanes[lane].dropped << "\n";
+        }
+    }
+    writeHeader(out, "thenews_dispatch_coalesced_total", "counter", "Toasts not queued because the same one was waiting.");
+    for (std::size_t i = 0; i < dispatch.size(); i++) {
+        out << "thenews_dispatch_coalesced_total{dispatcher=\"" << i << "\"} " << dispatch[i].coalesced << "\n";
+    }
+
+    writeHeader(out, "thenews_image_cache_hits_total", "counter", "Toast images served from the cache.");
+    out << "thenews_image_cache_hits_total " << cache.hits << "\n";
+    writeHeader(out, "thenews_image_cache_misses_total", "counter", "Toast images that had to be decoded or mapped.");
+    out << "thenews_image_cache_misses_total " << cache.misses << "\n";
+    writeHeader(out, "thenews_image_cache_bytes", "gauge", "Decoded image bytes held by the cache.");
+    out << "thenews_image_cache_bytes " << cache.bytes << "\n";
+    writeHeader(out, "thenews_notification_pool_size", "gauge", "Built notifications waiting to be shown again.");
+    out << "thenews_notification_pool_size " << pool.pooled << "\n";
+    writeHeader(out, "thenews_notification_pool_reused_total", "counter", "Sends that reused a pooled notification.");
+    out << "thenews_notification_pool_reused_total " << pool.reused << "\n";
+    return out.str();
+}
+
+MetricsExporter::~MetricsExporter() {
+    if (m_thread.joinable()) {
+        g_main_context_invoke(m_context, &MetricsExporter::quit, m_loop);
+        m_thread.join();
+    }
+    if (m_loop) {
+        g_main_loop_unref(m_loop);
+        g_main_context_unref(m_context);
+    }
+    if (m_listenFd >= 0) {
+        close(m_listenFd);
+        unlink(m_socketPath.c_str());
+    }
+}
+
+bool MetricsExporter::listen(const std::string &socketPath, std::string &error) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        error = "metrics socket path is too long: " + socketPath;
+        return false;
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = std::string("couldnt make a socket: ") + std::strerror(errno);
+        return false;
+    }
+    int bound = bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    if (bound < 0 && errno == EADDRINUSE) {
+        // same as the control socket, only take it over if nobody answers
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool alive = probe >= 0 && connect(probe, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+        if (probe >= 0) {
+            close(probe);
+        }
+        if (alive) {
+            error = "something is already serving metrics on " + socketPath;
+            close(fd);
+            return false;
+        }
+        unlink(socketPath.c_str());
+        bound = bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    }
+    if (bound < 0 || ::listen(fd, 16) < 0) {
+        error = "couldnt listen on " + socketPath + ": " + std::strerror(errno);
+        close(fd);
+        return false;
+    }
+    m_listenFd = fd;
+    m_socketPath = socketPath;
+    return true;
+}
+
+void MetricsExporter::setLogInterval(std::chrono::seconds interval) {
+    m_logInterval = interval;
+}
+
+void MetricsExporter::start() {
+    if (m_thread.joinable() || (m_listenFd < 0 && m_logInterval.count() <= 0)) {
+        return;
+    }
+    m_context = g_main_context_new();
+    m_loop = g_main_loop_new(m_context, FALSE);
+
+    if (m_listenFd >= 0) {
+        GSource *source = g_unix_fd_source_new(m_listenFd, G_IO_IN);
+        g_source_set_callback(source, G_SOURCE_FUNC(&MetricsExporter::accept), this, nullptr);
+        g_source_attach(source, m_context);
+        g_source_unref(source);
+    }
+    if (m_logInterval.count() > 0) {
+        m_lastLog = std::chrono::steady_clock::now();
+        GSource *source = g_timeout_source_new_seconds(static_cast<guint>(m_logInterval.count()));
+        g_source_set_callback(source, &MetricsExporter::log, this, nullptr);
+        g_source_attach(source, m_context);
+        g_source_unref(source);
+    }
+    m_thread = std::thread(&MetricsExporter::run, this);
+}
+
+void MetricsExporter::run() {
+    g_main_context_push_thread_default(m_context);
+    g_main_loop_run(m_loop);
+    g_main_context_pop_thread_default(m_context);
+}
+
+gboolean MetricsExporter::quit(gpointer loop) {
+    g_main_loop_quit(static_cast<GMainLoop *>(loop));
+    return G_SOURCE_REMOVE;
+}
+
+gboolean MetricsExporter::log(gpointer self) {
+    auto *exporter = static_cast<MetricsExporter *>(self);
+    auto now = std::chrono::steady_clock::now();
+    std::uint64_t sent = NotificationMetrics::instance().total().sent;
+    double seconds = std::chrono::duration<double>(now - exporter->m_lastLog).count();
+
+    char rate[32];
+    std::snprintf(rate, sizeof(rate), "%.1f/s", seconds > 0 ? static_cast<double>(sent - exporter->m_lastSent) / seconds : 0.0);
+    std::cerr << "stats: " << rate << ", " << NotificationMetrics::instance().summary() << "\n";
+
+    exporter->m_lastSent = sent;
+    exporter->m_lastLog = now;
+    return G_SOURCE_CONTINUE;
+}
+
+gboolean MetricsExporter::accept(gint fd, GIOCondition, gpointer self) {
+    while (true) {
+        int client = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            break;
+        }
+        static_cast<MetricsExporter *>(self)->serve(client);
+        close(client);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+void MetricsExporter::serve(int fd) {
+    // scrapers send their request right away, a client that says nothing
+    // within 100ms just gets the text. either way its one answer and hang up
+    char request[1024];
+    ssize_t n = 0;
+    pollfd readable{fd, POLLIN, 0};
+    if (poll(&readable, 1, 100) > 0) {
+        n = recv(fd, request, sizeof(request), MSG_DONTWAIT);
+    }
+    bool http = n >= 4 && std::memcmp(request, "GET ", 4) == 0;
+
+    std::string body = NotificationMetrics::instance().prometheus();
+    std::string response;
+    if (http) {
+        response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                   std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+    }
+    response += body;
+
+    // a scraper that stops reading doesnt get to hold up the next one for long
+    timeval timeout{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    std::size_t written = 0;
+    while (written < response.size()) {
+        ssize_t sent = send(fd, response.data() + written, response.size() - written, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return;
+        }
+        written += static_cast<std::size_t>(sent);
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <glib.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "catalog.h"
+
+class NotificationDispatcher;
+
+// what sendNotification actually costs. every send records how long it took
+// to get the notification ready (building it, image hints) and how long
+// notify_notification_show blocked, per type, and every failure gets counted
+// by its GError domain and code. thenews --stats prints it, --stats-interval
+// logs a line every so often and --metrics-socket serves it for prometheus
+
+// fixed buckets so recording is just a few adds, the percentiles you get out
+// are the upper edge of the bucket they fall in
+class LatencyHistogram {
+public:
+    static constexpr std::array<std::uint32_t, 15> bounds = {{
+        10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000
+    }}; // microseconds, anything slower lands in the last (+Inf) bucket
+
+    void record(std::chrono::steady_clock::duration duration);
+
+    // q between 0 and 1, in microseconds. 0 if nothing was recorded
+    std::uint64_t percentile(double q) const;
+
+    std::uint64_t count = 0;
+    std::uint64_t sumUs = 0;
+    std::array<std::uint64_t, bounds.size() + 1> buckets{};
+};
+
+struct NotificationTypeMetrics {
+    std::uint64_t sent = 0;
+    std::uint64_t failed = 0;
+    LatencyHistogram prepare; // notification built or taken from the pool, image hints set
+    LatencyHistogram show;    // notify_notification_show, the d-bus round trip
+};
+
+class NotificationMetrics {
+public:
+    static NotificationMetrics &instance();
+
+    // sendNotification calls these. id is NotificationId::Count for toasts
+    // that werent in the catalog
+    void recordSend(NotificationId id, bool ok, std::chrono::steady_clock::duration prepare,
+                    std::chrono::steady_clock::duration show);
+    void recordError(const char *domain, int code);
+    void recordError(const GError *error);
+
+    // the dispatcher calls this with how long each toast sat in its queue
+    void recordQueueWait(std::chrono::steady_clock::duration waited);
+
+    // NotificationEvents calls these when a toast we sent gets an action or
+    // closes, and with how long it took from the signal coming in to whoever
+    // handles it (the qt thread or thenews --wait)
+    void recordEvent(bool action);
+    void recordEventDelivery(std::chrono::steady_clock::duration delivery);
+
+    // dispatchers register themselves so their queue depth shows up too
+    void addDispatcher(const NotificationDispatcher *dispatcher);
+    void removeDispatcher(const NotificationDispatcher *dispatcher);
+
+    NotificationTypeMetrics type(NotificationId id) const;
+    NotificationTypeMetrics total() const;
+    std::map<std::pair<std::string, int>, std::uint64_t> errors() const;
+
+    // the table thenews --stats prints
+    void print(std::ostream &out) const;
+    // one line, for the periodic log
+    std::string summary() const;
+    // text exposition format, with the image cache, pool and dispatch counts
+    std::string prometheus() const;
+
+private:
+    NotificationMetrics() = default;
+    NotificationMetrics(const NotificationMetrics &) = delete;
+    NotificationMetrics &operator=(const NotificationMetrics &) = delete;
+
+    mutable std::mutex m_mutex;
+    std::array<NotificationTypeMetrics, notificationCount + 1> m_types; // last one is unknown
+    std::map<std::pair<std::string, int>, std::uint64_t> m_errors;
+    LatencyHistogram m_queueWait;
+    std::uint64_t m_actions = 0;
+    std::uint64_t m_closed = 0;
+    LatencyHistogram m_eventDelivery;
+    std::vector<const NotificationDispatcher *> m_dispatchers;
+};
+
+// serves NotificationMetrics::prometheus() on a unix socket and/or logs
+// summary() to stderr every interval, from its own thread with its own
+// GMainContext so a slow scraper never holds up a toast. the socket answers
+// "GET /metrics" with a bare http response (curl --unix-socket works) and
+// anything else, including just connecting and reading, with the plain text
+class MetricsExporter {
+public:
+    MetricsExporter() = default;
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter &) = delete;
+    MetricsExporter &operator=(const MetricsExporter &) = delete;
+
+    // both optional, call before start()
+    bool listen(const std::string &socketPath, std::string &error);
+    void setLogInterval(std::chrono::seconds interval);
+
+    // does nothing if neither was asked for
+    void start();
+
+private:
+    void run();
+    static gboolean accept(gint fd, GIOCondition condition, gpointer self);
+    static gboolean log(gpointer self);
+    static gboolean quit(gpointer loop);
+    void serve(int fd);
+
+    GMainContext *m_context = nullptr;
+    GMainLoop *m_loop = nullptr;
+    std::thread m_thread;
+
+    int m_listenFd = -1;
+    std::string m_socketPath;
+    std::chrono::seconds m_logInterval{0};
+    std::uint64_t m_lastSent = 0;
+    std::chrono::steady_clock::time_point m_lastLog;
+};
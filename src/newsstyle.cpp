@@ -0,0 +1,63 @@
+#include "newsstyle.h"
+
+#include <vector>
+
+#include <QApplication>
+#include <QColor>
+#include <QPalette>
+#include <QPushButton>
+#include <QString>
+#include <QVariant>
+
+namespace {
+
+const char *colorProperty = "newsButtonColor";
+
+std::vector<QRgb> &knownColors() {
+    static std::vector<QRgb> colors;
+    return colors;
+}
+
+QString rgba(const QColor &color) {
+    return QString("rgba(%1, %2, %3, %4)").arg(color.red()).arg(color.green()).arg(color.blue()).arg(color.alpha());
+}
+
+QString colorKey(QRgb rgb) {
+    return QString::number(rgb & 0xffffff, 16);
+}
+
+QString buildStyleSheet() {
+    QString sheet;
+    for (QRgb rgb : knownColors()) {
+        QColor baseColor = QColor::fromRgb(rgb);
+        baseColor.setAlpha(100);
+
+        QColor hoverColor = baseColor.lighter(110);
+        hoverColor.setAlpha(100);
+
+        QColor pressColor = baseColor.darker(120);
+        pressColor.setAlpha(100);
+
+        QString selector = QString("QPushButton[%1=\"%2\"]").arg(colorProperty, colorKey(rgb));
+        sheet += selector + " { background-color: " + rgba(baseColor) + "; color: black; border: 1px solid black; } ";
+        sheet += selector + ":hover { background-color: " + rgba(hoverColor) + "; } ";
+        sheet += selector + ":pressed { background-color: " + rgba(pressColor) + "; } ";
+    }
+    return sheet;
+}
+
+} // namespace
+
+void applyNewsButtonStyle(QPushButton *btn) {
+    QRgb rgb = btn->palette().color(QPalette::Button).rgb();
+    btn->setProperty(colorProperty, colorKey(rgb));
+
+    auto &colors = knownColors();
+    for (QRgb known : colors) {
+        if (known == rgb) {
+            return;
+        }
+    }
+    colors.push_back(rgb);
+    qApp->setStyleSheet(buildStyleSheet());
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+class QPushButton;
+
+// the see-through grey button look, as one application wide stylesheet
+// instead of a separate stylesheet on every button. applyNewsButtonStyle()
+// just tags the button with its palette color, the stylesheet has one rule
+// per color and only gets rebuilt when a color shows up that it hasnt seen
+
+void applyNewsButtonStyle(QPushButton *btn);
@@ -0,0 +1,283 @@
+#include "newswindow.h"
+
+#include "backgroundwidget.h"
+#include "dispatcher.h"
+#include "newsstyle.h"
+#include "skewedbutton.h"
+#include "startupprofile.h"
+#include "ui_page1.h"
+#include "ui_page2.h"
+
+#include <QComboBox>
+#include <QFont>
+#include <QHBoxLayout>
+#include <QIcon>
+#include <QLabel>
+#include <QPushButton>
+#include <QSlider>
+#include <QStackedWidget>
+#include <QTimer>
+
+static SkewedButton *replaceWithSkewed(QPushButton *original, double skewX, double skewY, double translateX, double translateY, double rotation) {
+    SkewedButton *skewed = new SkewedButton(original->parentWidget());
+    skewed->setGeometry(original->geometry());
+    skewed->setText(original->text());
+    skewed->setPalette(original->palette());
+    skewed->setSkewTransform(skewX, skewY, translateX, translateY, rotation);
+    
+    original->hide();
+    return skewed;
+}
+
+// the .ui files keep their border-image labels so designer still shows the
+// pictures, at runtime they get swapped for one that scales once
+static BackgroundWidget *replaceWithBackground(QLabel *original, ResourceId image) {
+    BackgroundWidget *background = new BackgroundWidget(original->parentWidget());
+    background->setGeometry(original->geometry());
+    background->setImage(resourcePath(image));
+    background->stackUnder(original);
+
+    original->hide();
+    return background;
+}
+
+NewsWindow::NewsWindow(NotificationDispatcher &dispatcher, StartupProfile &profile, QWidget *parent)
+    : QMainWindow(parent),
+      m_dispatcher(dispatcher),
+      m_profile(profile),
+      m_stackedWidget(new QStackedWidget()),
+      m_ui(std::make_unique<Ui_MainWindow>()),
+      m_autoToast(dispatcher) {
+    setWindowIcon(QIcon(resourcePath(ResourceId::ThenewsPng)));
+    setWindowTitle("the news");
+
+    buildPage1();
+    buildAutoToast();
+
+    setCentralWidget(m_stackedWidget);
+}
+
+NewsWindow::~NewsWindow() = default;
+
+void NewsWindow::bindNotification(QPushButton *btn, NotificationId id) {
+    NotificationDispatcher *dispatcher = &m_dispatcher;
+    QObject::connect(btn, &QPushButton::clicked, [dispatcher, id]() {
+        dispatcher->enqueue(id);
+    });
+}
+
+void NewsWindow::buildPage1() {
+    // page 1!
+    m_page1Window = new QMainWindow();
+    m_ui->setupUi(m_page1Window);
+    m_stackedWidget->addWidget(m_page1Window);
+    m_profile.mark("setupUi page 1");
+
+    Ui_MainWindow &ui = *m_ui;
+
+    replaceWithBackground(ui.label, ResourceId::ReporterPng);
+    replaceWithBackground(ui.roadblockman, ResourceId::RoadblockmanPng);
+    m_profile.mark("backgrounds page 1");
+
+    auto skewedDonation = replaceWithSkewed(ui.donation, 0, 29.612, -11.22, 18.454, 31.3);
+    bindNotification(skewedDonation, NotificationId::Donate);
+
+    auto skewedSysem32 = replaceWithSkewed(ui.sysem32, 0, 13.325, 0, 8.763, 0);
+    bindNotification(skewedSysem32, NotificationId::DeleteSystem32);
+
+    auto skewedJohnPhone = replaceWithSkewed(ui.johnPhone, -30.472, 0, -52.662, 0, 0);
+    bindNotification(skewedJohnPhone, NotificationId::IncomingCall);
+
+    auto skewedJohnPhoneFQ = replaceWithSkewed(ui.johnPhoneFQ, -16.861, 0, 5.796, 0, 0);
+    bindNotification(skewedJohnPhoneFQ, NotificationId::FriendRequest);
+
+    auto skewedRoadblocks = replaceWithSkewed(ui.roadblocks, 0, 8.005, 0, 4.359, 0);
+    bindNotification(skewedRoadblocks, NotificationId::Roadblocks);
+    m_profile.mark("skew replacement page 1");
+
+    bindNotification(ui.someoneDied, NotificationId::SomeoneDied);
+    bindNotification(ui.alarm, NotificationId::ServersDying);
+    bindNotification(ui.weather, NotificationId::EarthOnFire);
+    bindNotification(ui.redesign, NotificationId::WebsiteRedesign);
+    bindNotification(ui.linkie, NotificationId::LinkerTragedy);
+
+    QObject::connect(ui.page2, &QPushButton::clicked, [this]() {
+        showPage(1);
+    });
+
+    applyNewsButtonStyle(ui.someoneDied);
+    applyNewsButtonStyle(ui.alarm);
+    applyNewsButtonStyle(ui.weather);
+    applyNewsButtonStyle(ui.redesign);
+    applyNewsButtonStyle(ui.linkie);
+    applyNewsButtonStyle(ui.page2);
+    m_profile.mark("button style page 1");
+}
+
+void NewsWindow::buildPage2() {
+    // ok now we stack page 2 on it
+    m_page2Ui = std::make_unique<Ui_Page2Window>();
+    m_page2Window = new QMainWindow();
+    m_page2Ui->setupUi(m_page2Window);
+    m_stackedWidget->addWidget(m_page2Window);
+    m_profile.mark("setupUi page 2");
+
+    Ui_Page2Window &page2Ui = *m_page2Ui;
+
+    replaceWithBackground(page2Ui.label2, ResourceId::Reporter2Jpg);
+    replaceWithBackground(page2Ui.snakeWithHat, ResourceId::SnakewithhatJpg);
+    m_profile.mark("backgrounds page 2");
+
+    auto skewedMazeGambled = replaceWithSkewed(page2Ui.mazeGambled, -45, 0, 16, 0, 0);
+    bindNotification(skewedMazeGambled, NotificationId::MazeGambled);
+
+    auto skewedFemboyLabs = replaceWithSkewed(page2Ui.femboyLabs, 31.997, 0, -9.375, 2.713, -16.137);
+    bindNotification(skewedFemboyLabs, NotificationId::FemboyLabs);
+
+    auto skewedBaseballEmoji = replaceWithSkewed(page2Ui.baseballEmoji, -61.557, 0, -6.784, 0, 0);
+    bindNotification(skewedBaseballEmoji, NotificationId::BaseballEmoji);
+
+    auto skewedLinkerAgain = replaceWithSkewed(page2Ui.linkerAgain, -19.44, 0, 5.647, 0, 0);
+    bindNotification(skewedLinkerAgain, NotificationId::LinkerAgain);
+    m_profile.mark("skew replacement page 2");
+
+    bindNotification(page2Ui.bussinIndustries, NotificationId::BussinIndustries);
+    bindNotification(page2Ui.hTile, NotificationId::HTile);
+    bindNotification(page2Ui.jonathanPork, NotificationId::JonathanPork);
+    bindNotification(page2Ui.hGif, NotificationId::HGif);
+    bindNotification(page2Ui.findMeOnline, NotificationId::FindMeOnline);
+    bindNotification(page2Ui.googServices, NotificationId::GoogServices);
+    bindNotification(page2Ui.flash, NotificationId::Flash);
+    bindNotification(page2Ui.coffee, NotificationId::Mcafee);
+    bindNotification(page2Ui.noskid, NotificationId::Noskid);
+    bindNotification(page2Ui.linkerAgain, NotificationId::LinkerAgain);
+    bindNotification(page2Ui.baseballEmoji, NotificationId::BaseballEmoji);
+    bindNotification(page2Ui.mazeGambled, NotificationId::MazeGambled);
+    bindNotification(page2Ui.femboyLabs, NotificationId::FemboyLabs);
+
+    QObject::connect(page2Ui.backButton, &QPushButton::clicked, [this]() {
+        showPage(0);
+    });
+
+    applyNewsButtonStyle(page2Ui.bussinIndustries);
+    applyNewsButtonStyle(page2Ui.hTile);
+    applyNewsButtonStyle(page2Ui.jonathanPork);
+    applyNewsButtonStyle(page2Ui.hGif);
+    applyNewsButtonStyle(page2Ui.findMeOnline);
+    applyNewsButtonStyle(page2Ui.googServices);
+    applyNewsButtonStyle(page2Ui.flash);
+    applyNewsButtonStyle(page2Ui.coffee);
+    applyNewsButtonStyle(page2Ui.noskid);
+    applyNewsButtonStyle(page2Ui.backButton);
+    m_profile.mark("button style page 2");
+}
+
+void NewsWindow::showPage(int index) {
+    if (index == 1 && !m_page2Window) {
+        buildPage2();
+    }
+    m_stackedWidget->setCurrentIndex(index);
+}
+
+bool NewsWindow::page2Built() const {
+    return m_page2Window != nullptr;
+}
+
+void NewsWindow::setTitleFont(const QString &family) {
+    QFont customFont(family);
+    customFont.setPixelSize(36);
+    customFont.setItalic(true);
+    m_ui->welcomeTheNews->setFont(customFont);
+    m_ui->donation->setFont(customFont);
+}
+
+void NewsWindow::buildAutoToast() {
+    // auto toast from page 1
+    QPushButton *autoToastButton = new QPushButton("Start Auto Toast");
+    autoToastButton->setGeometry(623, 76, 182, 293);
+    autoToastButton->setParent(m_page1Window->centralWidget());
+    applyNewsButtonStyle(autoToastButton);
+
+    QWidget *intervalContainer = new QWidget(m_page1Window->centralWidget());
+    intervalContainer->setGeometry(389, 343, 400, 100);
+
+    QHBoxLayout *intervalLayout = new QHBoxLayout(intervalContainer);
+    intervalLayout->setContentsMargins(0, 0, 0, 0);
+
+    QLabel *intervalTextLabel = new QLabel("Toast Interval:");
+    intervalLayout->addWidget(intervalTextLabel);
+
+    QSlider *intervalSlider = new QSlider(Qt::Horizontal);
+    intervalSlider->setMinimum(0);
+    intervalSlider->setMaximum(5000);
+    intervalSlider->setValue(100);
+    intervalSlider->setFixedWidth(200);
+    intervalLayout->addWidget(intervalSlider);
+
+    QLabel *intervalValueLabel = new QLabel("Interval: 100ms");
+    intervalLayout->addWidget(intervalValueLabel);
+
+    // playlist picker and live numbers under the slider
+    QWidget *statsContainer = new QWidget(m_page1Window->centralWidget());
+    statsContainer->setGeometry(389, 420, 400, 40);
+
+    QHBoxLayout *statsLayout = new QHBoxLayout(statsContainer);
+    statsLayout->setContentsMargins(0, 0, 0, 0);
+
+    m_playlistBox = new QComboBox();
+    for (AutoToastPlaylist playlist : {AutoToastPlaylist::Classic, AutoToastPlaylist::Sequential, AutoToastPlaylist::Random, AutoToastPlaylist::Weighted}) {
+        m_playlistBox->addItem(autoToastPlaylistName(playlist), static_cast<int>(playlist));
+    }
+    statsLayout->addWidget(m_playlistBox);
+
+    QLabel *statsLabel = new QLabel();
+    statsLayout->addWidget(statsLabel, 1);
+
+    m_autoToast.setInterval(std::chrono::milliseconds(intervalSlider->value()));
+
+    QObject::connect(intervalSlider, &QSlider::valueChanged, [this, intervalValueLabel](int value) {
+        intervalValueLabel->setText(QString("Interval: %1ms").arg(value));
+        m_autoToast.setInterval(std::chrono::milliseconds(value));
+    });
+
+    QObject::connect(m_playlistBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [this](int index) {
+        m_autoToast.setPlaylist(static_cast<AutoToastPlaylist>(m_playlistBox->itemData(index).toInt()));
+    });
+
+    QTimer *statsTimer = new QTimer(this);
+    statsTimer->setInterval(500);
+    QObject::connect(statsTimer, &QTimer::timeout, [this, statsLabel]() {
+        AutoToastStats stats = m_autoToast.stats();
+        statsLabel->setText(QString("%1/s  p50 %2ms  p99 %3ms  dropped %4")
+            .arg(stats.achievedRate, 0, 'f', 1)
+            .arg(stats.p50LatencyMs, 0, 'f', 1)
+            .arg(stats.p99LatencyMs, 0, 'f', 1)
+            .arg(stats.missedTicks + stats.limitedTicks));
+    });
+
+    QObject::connect(autoToastButton, &QPushButton::clicked, [this, autoToastButton, statsTimer]() {
+        if (!m_autoToast.isRunning()) {
+            m_autoToast.start();
+            statsTimer->start();
+            autoToastButton->setText("Stop Auto Toast");
+        } else {
+            m_autoToast.stop();
+            statsTimer->stop();
+            autoToastButton->setText("Start Auto Toast");
+        }
+    });
+    m_profile.mark("auto toast controls");
+}
+
+AutoToastScheduler &NewsWindow::autoToast() {
+    return m_autoToast;
+}
+
+void NewsWindow::setPlaylist(AutoToastPlaylist playlist) {
+    int index = m_playlistBox->findData(static_cast<int>(playlist));
+    if (index >= 0) {
+        // no currentIndexChanged if its already the one showing
+        m_playlistBox->setCurrentIndex(index);
+        m_autoToast.setPlaylist(playlist);
+    }
+}
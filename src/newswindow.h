@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+
+#include <QMainWindow>
+#include <QString>
+
+#include "autotoast.h"
+#include "catalog.h"
+
+class NotificationDispatcher;
+class QComboBox;
+class QPushButton;
+class QStackedWidget;
+class StartupProfile;
+class Ui_MainWindow;
+class Ui_Page2Window;
+
+// the news window. page 1 is built right away, page 2 only the first time
+// someone actually goes there
+
+class NewsWindow : public QMainWindow {
+public:
+    NewsWindow(NotificationDispatcher &dispatcher, StartupProfile &profile, QWidget *parent = nullptr);
+    ~NewsWindow() override;
+
+    void showPage(int index);
+    bool page2Built() const;
+
+    // the fancy font for the headline, loaded after the window is already up
+    void setTitleFont(const QString &family);
+
+    AutoToastScheduler &autoToast();
+    // goes through the picker on page 1 so it shows whats actually playing
+    void setPlaylist(AutoToastPlaylist playlist);
+
+private:
+    void buildPage1();
+    void buildPage2();
+    void buildAutoToast();
+    void bindNotification(QPushButton *btn, NotificationId id);
+
+    NotificationDispatcher &m_dispatcher;
+    StartupProfile &m_profile;
+
+    QStackedWidget *m_stackedWidget;
+    QMainWindow *m_page1Window = nullptr;
+    QMainWindow *m_page2Window = nullptr;
+    std::unique_ptr<Ui_MainWindow> m_ui;
+    std::unique_ptr<Ui_Page2Window> m_page2Ui;
+    QComboBox *m_playlistBox = nullptr;
+
+    AutoToastScheduler m_autoToast;
+};
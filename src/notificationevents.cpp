@@ -0,0 +1,236 @@
+#include "notificationevents.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <QMetaObject>
+#include <QObject>
+
+#include "metrics.h"
+
+namespace {
+
+constexpr std::size_t maxEarlyEvents = 32;
+
+} // namespace
+
+NotificationEvents &NotificationEvents::instance() {
+    static NotificationEvents events;
+    return events;
+}
+
+NotificationEvents::~NotificationEvents() {
+    if (m_thread.joinable()) {
+        g_main_context_invoke(m_context, &NotificationEvents::quit, m_loop);
+        m_thread.join();
+    }
+    if (m_connection) {
+        g_dbus_connection_signal_unsubscribe(m_connection, m_subscription);
+        g_object_unref(m_connection);
+        g_main_loop_unref(m_loop);
+        g_main_context_unref(m_context);
+    }
+}
+
+bool NotificationEvents::start(std::string *error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_connection) {
+        return true;
+    }
+
+    GError *busError = nullptr;
+    GDBusConnection *connection = g_bus_get_sync(G_BUS_TYPE_SESSION, nullptr, &busError);
+    if (!connection) {
+        if (error) {
+            *error = std::string("no session bus to hear back from toasts on: ") + (busError ? busError->message : "no idea why");
+        }
+        g_clear_error(&busError);
+        return false;
+    }
+
+    m_connection = connection;
+    m_context = g_main_context_new();
+    m_loop = g_main_loop_new(m_context, FALSE);
+
+    // signals land in the context thats the thread default when subscribing,
+    // so ours is for a moment. subscribing before start() returns means the
+    // match rule goes out on the connection ahead of any Notify sent after
+    g_main_context_push_thread_default(m_context);
+    m_subscription = g_dbus_connection_signal_subscribe(
+        m_connection, nullptr, "org.freedesktop.Notifications", nullptr, "/org/freedesktop/Notifications", nullptr,
+        G_DBUS_SIGNAL_FLAGS_NONE, &NotificationEvents::onSignal, this, nullptr);
+    g_main_context_pop_thread_default(m_context);
+
+    m_thread = std::thread(&NotificationEvents::run, this);
+    m_started = true;
+    return true;
+}
+
+bool NotificationEvents::started() const {
+    return m_started;
+}
+
+void NotificationEvents::run() {
+    g_main_context_push_thread_default(m_context);
+    g_main_loop_run(m_loop);
+    g_main_context_pop_thread_default(m_context);
+}
+
+gboolean NotificationEvents::quit(gpointer loop) {
+    g_main_loop_quit(static_cast<GMainLoop *>(loop));
+    return G_SOURCE_REMOVE;
+}
+
+void NotificationEvents::onSignal(GDBusConnection *, const gchar *, const gchar *, const gchar *, const gchar *signal,
+                                  GVariant *parameters, gpointer self) {
+    NotificationEvent event;
+    event.received = std::chrono::steady_clock::now();
+    if (g_strcmp0(signal, "ActionInvoked") == 0 && g_variant_is_of_type(parameters, G_VARIANT_TYPE("(us)"))) {
+        const gchar *action = nullptr;
+        g_variant_get(parameters, "(u&s)", &event.serverId, &action);
+        event.type = NotificationEventType::Action;
+        event.action = action;
+    } else if (g_strcmp0(signal, "NotificationClosed") == 0 && g_variant_is_of_type(parameters, G_VARIANT_TYPE("(uu)"))) {
+        g_variant_get(parameters, "(uu)", &event.serverId, &event.reason);
+        event.type = NotificationEventType::Closed;
+    } else {
+        // ActivationToken and whatever comes next
+        return;
+    }
+    static_cast<NotificationEvents *>(self)->handle(std::move(event));
+}
+
+bool NotificationEvents::claimLocked(NotificationEvent &event) {
+    auto it = m_tracked.find(event.serverId);
+    if (it == m_tracked.end()) {
+        return false;
+    }
+    event.id = it->second;
+    if (event.type == NotificationEventType::Closed) {
+        m_tracked.erase(it);
+    }
+    return true;
+}
+
+void NotificationEvents::recordLocked(const NotificationEvent &event) {
+    if (event.type == NotificationEventType::Action) {
+        m_actions++;
+        if (!m_haveAction) {
+            m_haveAction = true;
+            m_firstAction = event;
+        }
+    } else {
+        m_closed++;
+        m_lastClosed = event;
+    }
+    NotificationMetrics::instance().recordEvent(event.type == NotificationEventType::Action);
+}
+
+void NotificationEvents::handle(NotificationEvent event) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!claimLocked(event)) {
+            m_early.push_back(std::move(event));
+            if (m_early.size() > maxEarlyEvents) {
+                m_early.pop_front();
+            }
+            return;
+        }
+        recordLocked(event);
+    }
+    m_changed.notify_all();
+    dispatch(event);
+}
+
+void NotificationEvents::track(std::uint32_t serverId, NotificationId id) {
+    if (serverId == 0) {
+        return;
+    }
+
+    std::vector<NotificationEvent> early;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tracked[serverId] = id;
+        m_trackedAny = true;
+        // the server was quicker than whoever called us
+        for (auto it = m_early.begin(); it != m_early.end();) {
+            if (it->serverId != serverId) {
+                ++it;
+                continue;
+            }
+            early.push_back(std::move(*it));
+            it = m_early.erase(it);
+            claimLocked(early.back());
+            recordLocked(early.back());
+        }
+    }
+    if (early.empty()) {
+        return;
+    }
+    m_changed.notify_all();
+    for (const NotificationEvent &event : early) {
+        dispatch(event);
+    }
+}
+
+void NotificationEvents::setCallback(QObject *context, Callback callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_callbackContext = context;
+    m_callback = std::move(callback);
+}
+
+void NotificationEvents::dispatch(const NotificationEvent &event) {
+    QObject *context;
+    Callback callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        context = m_callbackContext;
+        callback = m_callback;
+    }
+
+    if (!callback) {
+        return;
+    }
+    if (context) {
+        QMetaObject::invokeMethod(context, [callback, event]() {
+            NotificationMetrics::instance().recordEventDelivery(std::chrono::steady_clock::now() - event.received);
+            callback(event);
+        }, Qt::QueuedConnection);
+    } else {
+        NotificationMetrics::instance().recordEventDelivery(std::chrono::steady_clock::now() - event.received);
+        callback(event);
+    }
+}
+
+bool NotificationEvents::wait(std::chrono::milliseconds timeout, NotificationEvent &event) {
+    auto waitStart = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_trackedAny) {
+        return false;
+    }
+    auto done = [this]() {
+        return m_haveAction || m_tracked.empty();
+    };
+    if (timeout.count() > 0) {
+        if (!m_changed.wait_for(lock, timeout, done)) {
+            return false;
+        }
+    } else {
+        m_changed.wait(lock, done);
+    }
+
+    event = m_haveAction ? m_firstAction : m_lastClosed;
+    // one that came in while the toasts were still going out was waiting on us, not the other way around
+    NotificationMetrics::instance().recordEventDelivery(std::chrono::steady_clock::now() - std::max(event.received, waitStart));
+    return true;
+}
+
+NotificationEventStats NotificationEvents::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    NotificationEventStats stats;
+    stats.actions = m_actions;
+    stats.closed = m_closed;
+    stats.tracked = m_tracked.size();
+    return stats;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <gio/gio.h>
+
+#include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "catalog.h"
+
+class QObject;
+
+// what happens to a toast after its shown: someone clicks one of its actions
+// or it goes away. libnotify only tells the NotifyNotification that was
+// shown, and only while something iterates the context it was first used
+// from, so toasts that got unreffed, re-shown from the pool or sent by a cli
+// that already exited never hear back. this listens for ActionInvoked and
+// NotificationClosed on the bus itself, from its own thread with its own
+// GMainContext, and matches them up by server id with the toasts
+// sendNotification tracked. the gui gets them on the qt thread through
+// setCallback, the cli can block in wait() (thenews --wait)
+
+enum class NotificationEventType : std::uint8_t {
+    Action,
+    Closed
+};
+
+struct NotificationEvent {
+    NotificationEventType type = NotificationEventType::Action;
+    NotificationId id = NotificationId::Count; // Count for toasts we didnt send
+    std::uint32_t serverId = 0;
+    std::string action;       // the action id, Action only
+    std::uint32_t reason = 0; // Closed only: 1 expired, 2 dismissed, 3 closed by a call, 4 who knows
+    std::chrono::steady_clock::time_point received; // when the signal got to our thread
+};
+
+struct NotificationEventStats {
+    std::uint64_t actions = 0;
+    std::uint64_t closed = 0;
+    std::size_t tracked = 0; // toasts still on screen as far as we know
+};
+
+class NotificationEvents {
+public:
+    using Callback = std::function<void(const NotificationEvent &)>;
+
+    static NotificationEvents &instance();
+
+    // subscribes to the signals, call it before sending anything you want to
+    // hear back from. false with error filled in if theres no session bus
+    bool start(std::string *error = nullptr);
+    bool started() const;
+
+    // sendNotification calls this with the id the server gave a toast
+    void track(std::uint32_t serverId, NotificationId id);
+
+    // like NotificationDispatcher::setCallback, queued onto context's thread
+    void setCallback(QObject *context, Callback callback);
+
+    // blocks until a toast tracked so far gets an action (true, thats in
+    // event) or every one of them got closed (true, the last close is in
+    // event). false if timeout went by first or nothing was tracked, zero
+    // waits forever
+    bool wait(std::chrono::milliseconds timeout, NotificationEvent &event);
+
+    NotificationEventStats stats() const;
+
+private:
+    NotificationEvents() = default;
+    ~NotificationEvents();
+    NotificationEvents(const NotificationEvents &) = delete;
+    NotificationEvents &operator=(const NotificationEvents &) = delete;
+
+    void run();
+    static void onSignal(GDBusConnection *connection, const gchar *sender, const gchar *path, const gchar *interface,
+                         const gchar *signal, GVariant *parameters, gpointer self);
+    static gboolean quit(gpointer loop);
+    void handle(NotificationEvent event);
+    // fills in the id if its one of ours, false if it isnt
+    bool claimLocked(NotificationEvent &event);
+    void recordLocked(const NotificationEvent &event);
+    void dispatch(const NotificationEvent &event);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;
+
+    GDBusConnection *m_connection = nullptr;
+    guint m_subscription = 0;
+    GMainContext *m_context = nullptr;
+    GMainLoop *m_loop = nullptr;
+    std::thread m_thread;
+
+    std::atomic<bool> m_started{false};
+    std::unordered_map<std::uint32_t, NotificationId> m_tracked; // on screen, by server id
+    // signals nobody tracked yet. mostly other apps toasts, but the server
+    // can beat sendNotification to track() so the last few are kept around
+    std::deque<NotificationEvent> m_early;
+    bool m_trackedAny = false;
+    bool m_haveAction = false;
+    NotificationEvent m_firstAction;
+    NotificationEvent m_lastClosed;
+
+    QObject *m_callbackContext = nullptr;
+    Callback m_callback;
+
+    std::uint64_t m_actions = 0;
+    std::uint64_t m_closed = 0;
+};
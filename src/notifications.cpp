@@ -0,0 +1,372 @@
+#include "notifications.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include "animation.h"
+#include "dbusnotifier.h"
+#include "imagecache.h"
+#include "imagefiles.h"
+#include "metrics.h"
+#include "notificationevents.h"
+#include "notifybuild.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QString>
+#include <QTextStream>
+
+void createHDesktopFile() {
+    // free downloadable h
+    QString applicationsPath = QStandardPaths::writableLocation(QStandardPaths::ApplicationsLocation);
+    
+    QDir dir(applicationsPath);
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+    
+    QString iconPath = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/icons/h.gif";
+    QDir iconDir(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/icons");
+    if (!iconDir.exists()) {
+        iconDir.mkpath(".");
+    }
+    
+    QFile::copy(resourcePath(ResourceId::HGif), iconPath);
+    QFile::setPermissions(iconPath, QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup | QFile::ReadOther);
+    
+    QString desktopFilePath = applicationsPath + "/h.desktop";
+    QFile desktopFile(desktopFilePath);
+    
+    QString executablePath = QCoreApplication::applicationFilePath();
+    
+    if (desktopFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QTextStream out(&desktopFile);
+        out << "[Desktop Entry]\n";
+        out << "Type=Application\n";
+        out << "Name=h\n";
+        out << "Comment=h\n";
+        out << "Icon=" << iconPath << "\n";
+        out << "Exec=" << executablePath << " --h\n";
+        out << "Terminal=false\n";
+        out << "Categories=Utility;\n";
+        
+        desktopFile.close();
+        
+        QFile::setPermissions(desktopFilePath, 
+            QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner |
+            QFile::ReadGroup | QFile::ExeGroup |
+            QFile::ReadOther | QFile::ExeOther);
+        
+        std::cout << "h deployed at: " << desktopFilePath.toStdString() << "\n";
+    } else {
+        std::cerr << "failed to h...\n";
+    }
+}
+
+static std::atomic<NotificationImageMode> imageMode{NotificationImageMode::Inline};
+static std::atomic<bool> animationEnabled{false};
+static std::atomic<NotificationBackend> backend{NotificationBackend::Libnotify};
+
+// image-path is spec 1.2, asked once because its a round trip
+static bool serverTakesImagePath() {
+    static std::once_flag once;
+    static bool supported = false;
+    std::call_once(once, []() {
+        char *specVersion = nullptr;
+        if (notify_get_server_info(nullptr, nullptr, nullptr, &specVersion) && specVersion) {
+            int major = 0;
+            int minor = 0;
+            std::sscanf(specVersion, "%d.%d", &major, &minor);
+            supported = major > 1 || (major == 1 && minor >= 2);
+        }
+        g_free(specVersion);
+        if (!supported) {
+            std::cerr << "the notification server doesnt do image-path, sending images inline\n";
+        }
+    });
+    return supported;
+}
+
+GVariant *notificationImageHint(ResourceId id, const char *&key) {
+    if (imageMode == NotificationImageMode::Path && serverTakesImagePath()) {
+        std::string path = ImageFileCache::instance().path(id);
+        if (!path.empty()) {
+            gchar *uri = g_filename_to_uri(path.c_str(), nullptr, nullptr);
+            if (uri) {
+                key = "image-path";
+                return g_variant_ref_sink(g_variant_new_take_string(uri));
+            }
+        }
+    }
+
+    key = "image-data";
+    return ImageCache::instance().imageData(id);
+}
+
+void setNotificationImageFromResource(NotifyNotification *n, ResourceId id) {
+    const char *key = nullptr;
+    GVariant *hint = notificationImageHint(id, key);
+    if (!hint) {
+        return;
+    }
+
+    notify_notification_set_hint(n, key, hint);
+    g_variant_unref(hint);
+}
+
+void preloadNotificationImages() {
+    for (const auto &desc : notificationCatalog) {
+        if (desc.image != ResourceId::None && imageMode == NotificationImageMode::Path) {
+            ImageFileCache::instance().path(desc.image);
+        } else if (desc.image != ResourceId::None) {
+            GVariant *imageData = ImageCache::instance().imageData(desc.image);
+            if (imageData) {
+                g_variant_unref(imageData);
+            }
+        }
+    }
+}
+
+// no but seriously why
+static void doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing(NotifyNotification *notification, char *action, gpointer user_data) {
+    std::cout << "ok\n";
+}
+
+static NotifyNotification *prepareNotification(const NotificationDescriptor &desc) {
+    NotifyNotification *n = newCatalogNotification(desc, doAbsolutleyNothingBecauseWhyDoINeedThisAsAFunctionCantIJustDoNothing);
+    if (desc.image != ResourceId::None) {
+        setNotificationImageFromResource(n, desc.image);
+    }
+    return n;
+}
+
+// notifications that were already built and shown once, per type. the
+// content of a type never changes so a pooled one is ready to show again as
+// is, the only thing that differs is whether it keeps its server id
+namespace {
+
+constexpr std::size_t maxPooledPerType = 4;
+
+struct NotificationPool {
+    std::mutex mutex;
+    std::array<std::vector<NotifyNotification *>, notificationCount> idle;
+    NotificationReuse reuse = NotificationReuse::Stack;
+    std::uint64_t created = 0;
+    std::uint64_t reused = 0;
+};
+
+NotificationPool &notificationPool() {
+    static NotificationPool pool;
+    return pool;
+}
+
+} // namespace
+
+static NotifyNotification *acquireNotification(const NotificationDescriptor &desc) {
+    NotificationPool &pool = notificationPool();
+    NotificationReuse reuse;
+    NotifyNotification *n = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        auto &idle = pool.idle[static_cast<std::size_t>(desc.id)];
+        if (!idle.empty()) {
+            n = idle.back();
+            idle.pop_back();
+            pool.reused++;
+        } else {
+            pool.created++;
+        }
+        reuse = pool.reuse;
+    }
+
+    if (!n) {
+        return prepareNotification(desc);
+    }
+    if (reuse == NotificationReuse::Stack) {
+        // id 0 makes the server pop up a new one instead of replacing the old one
+        g_object_set(G_OBJECT(n), "id", 0, nullptr);
+    }
+    return n;
+}
+
+static void releaseNotification(const NotificationDescriptor &desc, NotifyNotification *n) {
+    NotificationPool &pool = notificationPool();
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        auto &idle = pool.idle[static_cast<std::size_t>(desc.id)];
+        if (idle.size() < maxPooledPerType) {
+            idle.push_back(n);
+            return;
+        }
+    }
+    g_object_unref(G_OBJECT(n));
+}
+
+void setNotificationImageMode(NotificationImageMode mode) {
+    if (imageMode.exchange(mode) != mode) {
+        // pooled notifications still carry the other kind of image hint
+        clearNotificationPool();
+    }
+}
+
+NotificationImageMode notificationImageMode() {
+    return imageMode;
+}
+
+void setNotificationAnimation(bool enabled) {
+    animationEnabled = enabled;
+}
+
+bool notificationAnimation() {
+    return animationEnabled;
+}
+
+void setNotificationBackend(NotificationBackend value) {
+    backend = value;
+}
+
+NotificationBackend notificationBackend() {
+    return backend;
+}
+
+void setNotificationReuse(NotificationReuse reuse) {
+    NotificationPool &pool = notificationPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.reuse = reuse;
+}
+
+NotificationReuse notificationReuse() {
+    NotificationPool &pool = notificationPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    return pool.reuse;
+}
+
+NotificationPoolStats notificationPoolStats() {
+    NotificationPool &pool = notificationPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    NotificationPoolStats stats;
+    stats.created = pool.created;
+    stats.reused = pool.reused;
+    for (const auto &idle : pool.idle) {
+        stats.pooled += idle.size();
+    }
+    return stats;
+}
+
+void clearNotificationPool() {
+    NotificationPool &pool = notificationPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    for (auto &idle : pool.idle) {
+        for (NotifyNotification *n : idle) {
+            g_object_unref(G_OBJECT(n));
+        }
+        idle.clear();
+    }
+    // the gdbus backend keeps its own prebuilt toasts
+    DBusNotifier::instance().clear();
+}
+
+static bool fail(std::string *error, const char *message) {
+    if (error) {
+        *error = message;
+    } else {
+        std::cerr << message << "\n";
+    }
+    return false;
+}
+
+bool sendNotification(const NotificationDescriptor &desc, std::string *error) {
+    // unfortunatley libnotify isnt as advanced like windows xaml com object whatever notifications so we have to remove some stuff to make it still work
+
+    {
+        // the dispatcher thread and the cli can both get here first
+        static std::mutex initMutex;
+        static bool initialized = false;
+        std::lock_guard<std::mutex> lock(initMutex);
+        if (!initialized) {
+            if (!notify_init("the news")) {
+                NotificationMetrics::instance().recordError("notify-init", 0);
+                NotificationMetrics::instance().recordSend(desc.id, false, {}, {});
+                return fail(error, "libnotify is not notifying");
+            }
+            initialized = true;
+        }
+    }
+
+    if (desc.deploysH) {
+        createHDesktopFile();
+    }
+
+    // an animated toast gets its own notification, the animator keeps
+    // re-showing it so it cant go back into the pool
+    std::shared_ptr<const AnimationFrames> frames;
+    if (animationEnabled && desc.image != ResourceId::None) {
+        frames = animationFrames(desc.image);
+    }
+
+    auto prepareStart = std::chrono::steady_clock::now();
+    if (backend == NotificationBackend::GDBus && !frames) {
+        return DBusNotifier::instance().send(desc, error);
+    }
+
+    bool pooled = desc.id != NotificationId::Count && !frames;
+    NotifyNotification *n = pooled ? acquireNotification(desc) : prepareNotification(desc);
+    if (frames) {
+        notify_notification_set_hint(n, "image-data", frames->frames[0]);
+    }
+
+    auto showStart = std::chrono::steady_clock::now();
+    bool shown = true;
+    GError *showError = nullptr;
+    if (!notify_notification_show(n, &showError)) {
+        shown = false;
+        NotificationMetrics::instance().recordError(showError);
+        if (showError) {
+            std::string message = std::string("error notifying the notification smh: ") + showError->message;
+            fail(error, message.c_str());
+            g_error_free(showError);
+        } else {
+            fail(error, "error notifying the notification smh");
+        }
+    }
+
+    NotificationMetrics::instance().recordSend(desc.id, shown, showStart - prepareStart,
+                                               std::chrono::steady_clock::now() - showStart);
+
+    if (shown && NotificationEvents::instance().started()) {
+        // by the server id, a pooled one gets a new id and its old toast stays up
+        gint serverId = 0;
+        g_object_get(G_OBJECT(n), "id", &serverId, nullptr);
+        NotificationEvents::instance().track(static_cast<std::uint32_t>(serverId), desc.id);
+    }
+
+    if (shown && frames) {
+        NotificationAnimator::instance().animate(n, frames);
+    }
+
+    if (pooled) {
+        releaseNotification(desc, n);
+    } else {
+        g_object_unref(G_OBJECT(n));
+    }
+    return shown;
+}
+
+bool sendNotification(NotificationId id, std::string *error) {
+    return sendNotification(notificationDescriptor(id), error);
+}
+
+bool sendNotification(const std::string &notificationType, std::string *error) {
+    NotificationId id;
+    if (findNotification(notificationType, id)) {
+        return sendNotification(id, error);
+    }
+    return sendNotification(unknownNotification, error);
+}
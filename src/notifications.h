@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glib.h>
+#include <libnotify/notify.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "catalog.h"
+
+// the part that actually talks to libnotify. everything here blocks on a
+// d-bus round trip, so the gui goes through NotificationDispatcher instead of
+// calling it directly
+
+void createHDesktopFile();
+
+void setNotificationImageFromResource(NotifyNotification *n, ResourceId id);
+
+// the hint setNotificationImageFromResource would set for id, key gets
+// "image-data" or "image-path". nullptr if theres no image, otherwise you own
+// a ref
+GVariant *notificationImageHint(ResourceId id, const char *&key);
+
+// how toast images get to the notification daemon. Inline sends the pixels
+// in the image-data hint every time, Path writes each image to a file once
+// (see imagefiles.h) and only sends its uri in the image-path hint. Path
+// falls back to Inline for servers older than spec 1.2 and for images that
+// couldnt be written out
+enum class NotificationImageMode : std::uint8_t {
+    Inline,
+    Path
+};
+
+void setNotificationImageMode(NotificationImageMode mode);
+NotificationImageMode notificationImageMode();
+
+// what sendNotification talks to the notification server with. Libnotify
+// waits for every toast's reply before returning, GDBus calls Notify itself
+// and keeps sending while replies are still out (see dbusnotifier.h)
+enum class NotificationBackend : std::uint8_t {
+    Libnotify,
+    GDBus
+};
+
+void setNotificationBackend(NotificationBackend backend);
+NotificationBackend notificationBackend();
+
+// toasts with an animated image (h.gif) keep cycling through its frames
+// after theyre shown, see animation.h. off by default
+void setNotificationAnimation(bool enabled);
+bool notificationAnimation();
+
+// decodes every image in the catalog into the image cache up front
+void preloadNotificationImages();
+
+// returns false if the notification didnt make it. the reason goes into error
+// if you pass one, otherwise it gets printed to stderr
+bool sendNotification(const NotificationDescriptor &desc, std::string *error = nullptr);
+bool sendNotification(NotificationId id, std::string *error = nullptr);
+bool sendNotification(const std::string &notificationType, std::string *error = nullptr);
+
+// sendNotification keeps a few already built notifications per type around
+// and shows them again instead of building a new one every time.
+// Stack pops up a new notification every time like before, Replace reuses
+// the server id so a repeated toast replaces the one thats still on screen
+enum class NotificationReuse : std::uint8_t {
+    Stack,
+    Replace
+};
+
+struct NotificationPoolStats {
+    std::uint64_t created = 0; // sends that had to build a new notification
+    std::uint64_t reused = 0;  // sends that got one from the pool
+    std::size_t pooled = 0;    // notifications sitting in the pool right now
+};
+
+void setNotificationReuse(NotificationReuse reuse);
+NotificationReuse notificationReuse();
+NotificationPoolStats notificationPoolStats();
+void clearNotificationPool();
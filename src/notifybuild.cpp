@@ -0,0 +1,31 @@
+#include "notifybuild.h"
+
+static NotifyUrgency toNotifyUrgency(NotificationUrgency urgency) {
+    switch (urgency) {
+        case NotificationUrgency::Low: return NOTIFY_URGENCY_LOW;
+        case NotificationUrgency::Critical: return NOTIFY_URGENCY_CRITICAL;
+        default: return NOTIFY_URGENCY_NORMAL;
+    }
+}
+
+NotifyNotification *newCatalogNotification(const NotificationDescriptor &desc, NotifyActionCallback onAction) {
+    NotifyNotification *n = notify_notification_new(desc.title, desc.body, nullptr);
+
+    if (desc.urgency != NotificationUrgency::Normal) {
+        notify_notification_set_urgency(n, toNotifyUrgency(desc.urgency));
+    }
+    if (desc.category) {
+        notify_notification_set_hint(n, "category", g_variant_new_string(desc.category));
+    }
+    if (desc.progress >= 0) {
+        notify_notification_set_hint(n, "value", g_variant_new_int32(desc.progress));
+    }
+    if (desc.synchronous) {
+        notify_notification_set_hint(n, "synchronous", g_variant_new_string(desc.synchronous));
+    }
+    for (std::size_t i = 0; i < desc.actionCount; i++) {
+        notify_notification_add_action(n, desc.actions[i].id, desc.actions[i].label, onAction, nullptr, nullptr);
+    }
+
+    return n;
+}
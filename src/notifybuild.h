@@ -0,0 +1,10 @@
+#pragma once
+
+#include <libnotify/notify.h>
+
+#include "catalog.h"
+
+// a NotifyNotification with everything from desc but the image, which the
+// caller attaches from wherever it gets its pixels. thenews and
+// thenews-notify both build their toasts with this, so no qt in here
+NotifyNotification *newCatalogNotification(const NotificationDescriptor &desc, NotifyActionCallback onAction);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// the sample p of the way up from the smallest (0) to the largest (1), no
+// interpolating between two. takes a copy because it reorders it, 0 when
+// theres nothing. the benches and the auto toast stats all use this one so
+// their p99s mean the same thing
+
+inline double percentile(std::vector<double> samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::size_t index = static_cast<std::size_t>(std::clamp(p, 0.0, 1.0) * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index), samples.end());
+    return samples[index];
+}
@@ -0,0 +1,196 @@
+#include "skewedbutton.h"
+
+#include <QEnterEvent>
+#include <QEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPolygonF>
+#include <QRegion>
+#include <QtMath>
+
+SkewedButton::SkewedButton(QWidget *parent) : QPushButton(parent) {
+    setAttribute(Qt::WA_TranslucentBackground, false);
+    setAttribute(Qt::WA_OpaquePaintEvent, false);
+
+    // hover is tracked by hand against the skewed shape
+    setAttribute(Qt::WA_Hover, false);
+    setMouseTracking(true);
+}
+
+void SkewedButton::setSkewTransform(double skewX, double skewY, double translateX, double translateY, double rotation) {
+    m_skewX = skewX;
+    m_skewY = skewY;
+    m_translateX = translateX;
+    m_translateY = translateY;
+    m_rotation = rotation;
+    
+    QTransform transform;
+    QPointF center(width() / 2.0, height() / 2.0);
+    transform.translate(center.x(), center.y());
+    if (m_rotation != 0) {
+        transform.rotate(m_rotation);
+    }
+    double shearX = qTan(qDegreesToRadians(m_skewX));
+    double shearY = qTan(qDegreesToRadians(m_skewY));
+    transform.shear(shearX, shearY);
+    transform.translate(-center.x(), -center.y());
+    
+    QRectF transformedRect = transform.mapRect(QRectF(rect()));
+    
+    QRect originalGeom = geometry();
+    int extraLeft = qMax(0.0, -transformedRect.left());
+    int extraTop = qMax(0.0, -transformedRect.top());
+    int extraRight = qMax(0.0, transformedRect.right() - rect().width());
+    int extraBottom = qMax(0.0, transformedRect.bottom() - rect().height());
+    
+    m_originalRect = QRect(extraLeft, extraTop, originalGeom.width(), originalGeom.height());
+    
+    setGeometry(
+        originalGeom.x() - extraLeft,
+        originalGeom.y() - extraTop,
+        originalGeom.width() + extraLeft + extraRight,
+        originalGeom.height() + extraTop + extraBottom
+    );
+
+    updatePaintTransform();
+    invalidateCache();
+    update();
+}
+
+QRect SkewedButton::drawRect() const {
+    return m_originalRect.isNull() ? rect() : m_originalRect;
+}
+
+void SkewedButton::updatePaintTransform() {
+    QPointF center(QRectF(drawRect()).center());
+
+    QTransform transform;
+    transform.translate(center.x(), center.y());
+    if (m_rotation != 0) {
+        transform.rotate(m_rotation);
+    }
+    transform.shear(qTan(qDegreesToRadians(m_skewX)), qTan(qDegreesToRadians(m_skewY)));
+    transform.translate(-center.x(), -center.y());
+
+    m_paintTransform = transform;
+
+    bool invertible = false;
+    m_inverseTransform = transform.inverted(&invertible);
+
+    // the mask sends events over the see-through corners to whatever is
+    // underneath. its a pixel bigger than the shape so the antialiased
+    // edge doesnt get cut off
+    if (invertible && !m_originalRect.isNull()) {
+        QPolygonF shape = transform.map(QPolygonF(QRectF(drawRect()).adjusted(-1, -1, 1, 1)));
+        setMask(QRegion(shape.toPolygon()));
+    } else {
+        clearMask();
+    }
+}
+
+bool SkewedButton::hitButton(const QPoint &pos) const {
+    return QRectF(drawRect()).contains(m_inverseTransform.map(QPointF(pos)));
+}
+
+void SkewedButton::setHovered(bool hovered) {
+    if (m_hovered != hovered) {
+        m_hovered = hovered;
+        update();
+    }
+}
+
+void SkewedButton::invalidateCache() {
+    for (auto &pixmap : m_cache) {
+        pixmap = QPixmap();
+    }
+}
+
+QPixmap SkewedButton::render(State state, qreal dpr) const {
+    QPixmap pixmap(size() * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.setTransform(m_paintTransform);
+
+    QRect rect = drawRect();
+
+    QColor bgColor = palette().color(QPalette::Active, QPalette::Button);
+    QColor borderColor = Qt::black;
+
+    if (state == Pressed) {
+        bgColor = bgColor.darker(120);
+    } else if (state == Hover) {
+        bgColor = bgColor.lighter(110);
+    }
+
+    painter.fillRect(rect, bgColor);
+
+    painter.setPen(QPen(borderColor, 1));
+    painter.drawRect(rect.adjusted(0, 0, -1, -1));
+
+    painter.setPen(palette().color(QPalette::ButtonText));
+    painter.setFont(font());
+    painter.drawText(rect, Qt::AlignCenter, text());
+
+    return pixmap;
+}
+
+void SkewedButton::paintEvent(QPaintEvent *event) {
+    Q_UNUSED(event);
+
+    // text() has no change notification, so check it here
+    qreal dpr = devicePixelRatioF();
+    if (dpr != m_cacheDpr || text() != m_cacheText) {
+        invalidateCache();
+        m_cacheDpr = dpr;
+        m_cacheText = text();
+    }
+
+    State state = isDown() ? Pressed : (m_hovered ? Hover : Normal);
+    QPixmap &pixmap = m_cache[state];
+    if (pixmap.isNull()) {
+        pixmap = render(state, dpr);
+    }
+
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, pixmap);
+}
+
+void SkewedButton::resizeEvent(QResizeEvent *event) {
+    QPushButton::resizeEvent(event);
+    updatePaintTransform();
+    invalidateCache();
+}
+
+void SkewedButton::changeEvent(QEvent *event) {
+    switch (event->type()) {
+        case QEvent::PaletteChange:
+        case QEvent::FontChange:
+        case QEvent::StyleChange:
+            invalidateCache();
+            break;
+        default:
+            break;
+    }
+    QPushButton::changeEvent(event);
+}
+
+// pressing and releasing already repaint through setDown(), hover only
+// repaints when the mouse actually crosses the edge of the shape
+void SkewedButton::enterEvent(QEnterEvent *event) {
+    setHovered(hitButton(event->position().toPoint()));
+    QPushButton::enterEvent(event);
+}
+
+void SkewedButton::leaveEvent(QEvent *event) {
+    setHovered(false);
+    QPushButton::leaveEvent(event);
+}
+
+void SkewedButton::mouseMoveEvent(QMouseEvent *event) {
+    setHovered(hitButton(event->position().toPoint()));
+    QPushButton::mouseMoveEvent(event);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+
+#include <QPixmap>
+#include <QPoint>
+#include <QPushButton>
+#include <QRect>
+#include <QString>
+#include <QTransform>
+
+class QEnterEvent;
+class QMouseEvent;
+
+// a push button drawn skewed/rotated like the tiles in the original app.
+// the transform is worked out once in setSkewTransform() and each state
+// (normal, hover, pressed) is rendered into a pixmap the first time its
+// needed, so repainting is just drawing that pixmap. the pixmaps get thrown
+// away on resize and when the text, palette or font changes.
+// hover and clicks only count inside the actual skewed shape, not the
+// bounding box the widget had to grow to, so the see-through corners dont
+// steal events from the buttons underneath
+
+class SkewedButton : public QPushButton {
+public:
+    SkewedButton(QWidget *parent = nullptr);
+
+    void setSkewTransform(double skewX, double skewY, double translateX = 0, double translateY = 0, double rotation = 0);
+
+protected:
+    bool hitButton(const QPoint &pos) const override;
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void enterEvent(QEnterEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private:
+    enum State {
+        Normal,
+        Hover,
+        Pressed,
+        StateCount
+    };
+
+    QRect drawRect() const;
+    void updatePaintTransform();
+    void invalidateCache();
+    void setHovered(bool hovered);
+    QPixmap render(State state, qreal dpr) const;
+
+    double m_skewX = 0;
+    double m_skewY = 0;
+    double m_translateX = 0;
+    double m_translateY = 0;
+    double m_rotation = 0;
+    QRect m_originalRect;
+
+    QTransform m_paintTransform;
+    QTransform m_inverseTransform;
+    bool m_hovered = false;
+    std::array<QPixmap, StateCount> m_cache;
+    qreal m_cacheDpr = 0;
+    QString m_cacheText;
+};
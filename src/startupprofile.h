@@ -0,0 +1,40 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <QElapsedTimer>
+
+// timestamps for each step of getting the window up, printed with
+// --startup-profile so cold start regressions show up
+
+class StartupProfile {
+public:
+    StartupProfile() {
+        m_timer.start();
+    }
+
+    // records that phase just finished
+    void mark(const char *phase) {
+        m_marks.push_back({phase, m_timer.nsecsElapsed()});
+    }
+
+    void print(std::ostream &out) const {
+        out << "startup profile:\n";
+        qint64 previous = 0;
+        for (const auto &mark : m_marks) {
+            out << "  " << mark.at / 1000000.0 << " ms  (+" << (mark.at - previous) / 1000000.0 << " ms)  " << mark.phase << "\n";
+            previous = mark.at;
+        }
+    }
+
+private:
+    struct Mark {
+        std::string phase;
+        qint64 at; // ns since the profile was made
+    };
+
+    QElapsedTimer m_timer;
+    std::vector<Mark> m_marks;
+};
@@ -0,0 +1,127 @@
+// thenews-notify: thenews --someoneDied and friends without qt. no
+// QCoreApplication, no widgets, no image plugins, just libnotify and the
+// toast images straight out of the thenews.pack mapping (see assetpack.h),
+// so a scripted toast costs a process start and one d-bus round trip.
+//
+//   thenews-notify --someoneDied --incomingCall
+//
+// toasts go out in the order given. without a pack they go out without
+// their image. --hTile has to write the h desktop file with the icon from the
+// qrc, so anything asking for that gets handed to thenews next to us
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../assetpack.h"
+#include "../catalog.h"
+#include "../notifybuild.h"
+
+namespace {
+
+void printHelp() {
+    std::cout << "the news cli, the quick one\n\n";
+    std::cout << "usage: thenews-notify [OPTION]... NOTIFICATION...\n\n";
+    std::cout << "options:\n";
+    std::cout << "  --help                show this help message\n";
+    std::cout << "  --asset-pack FILE     take toast images from this pack instead of the one next to the executable\n";
+    std::cout << "  --no-asset-pack       send toasts without their image\n";
+    for (const auto &desc : notificationCatalog) {
+        std::string flag = "--" + std::string(desc.key);
+        std::cout << "  " << flag << std::string(flag.size() < 22 ? 22 - flag.size() : 1, ' ') << desc.help << "\n";
+    }
+}
+
+// the actions only do something while a main loop runs, which this never does
+void ignoreAction(NotifyNotification *, char *, gpointer) {}
+
+// execs thenews from the same directory with our arguments, only returns if that failed
+void handOverToThenews(char *argv[]) {
+    std::string self = AssetPack::defaultPath();
+    std::string thenews = self.substr(0, self.size() - std::strlen("thenews.pack")) + "thenews";
+    argv[0] = const_cast<char *>(thenews.c_str());
+    execv(thenews.c_str(), argv);
+    std::cerr << "couldnt run " << thenews << ": " << std::strerror(errno) << "\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string packPath = AssetPack::defaultPath();
+    bool usePack = true;
+    bool packAskedFor = false;
+    std::vector<const NotificationDescriptor *> toasts;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--help") {
+            printHelp();
+            return 0;
+        } else if (arg == "--asset-pack" && i + 1 < argc) {
+            packPath = argv[++i];
+            packAskedFor = true;
+        } else if (arg == "--no-asset-pack") {
+            usePack = false;
+        } else if (arg.substr(0, 2) == "--") {
+            NotificationId id;
+            if (!findNotification(arg.substr(2), id)) {
+                std::cerr << "no notification called " << arg.substr(2) << ", see --help\n";
+                return 1;
+            }
+            toasts.push_back(&notificationDescriptor(id));
+        }
+    }
+    if (toasts.empty()) {
+        printHelp();
+        return 1;
+    }
+    for (const NotificationDescriptor *desc : toasts) {
+        if (desc->deploysH) {
+            handOverToThenews(argv);
+            return 1;
+        }
+    }
+
+    AssetPack &pack = AssetPack::instance();
+    if (usePack) {
+        std::string error;
+        if (!pack.open(packPath, &error) && packAskedFor) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+    }
+
+    if (!notify_init("the news")) {
+        std::cerr << "libnotify is not notifying\n";
+        return 1;
+    }
+
+    int failed = 0;
+    for (const NotificationDescriptor *desc : toasts) {
+        NotifyNotification *n = newCatalogNotification(*desc, ignoreAction);
+        if (desc->image != ResourceId::None && pack.isOpen()) {
+            // the pack says what it was built with, whatever that is goes
+            ImageSize size;
+            GVariant *imageData = pack.imageData(resourcePath(desc->image), pack.maxDimension(), pack.opaqueAsRgb(), size);
+            if (imageData) {
+                notify_notification_set_hint(n, "image-data", imageData);
+                g_variant_unref(imageData);
+            }
+        }
+
+        GError *error = nullptr;
+        if (!notify_notification_show(n, &error)) {
+            std::cerr << "error notifying the notification smh" << (error ? std::string(": ") + error->message : std::string()) << "\n";
+            g_clear_error(&error);
+            failed++;
+        }
+        g_object_unref(G_OBJECT(n));
+    }
+
+    notify_uninit();
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,140 @@
+// build step that writes thenews.pack (see assetpack.h). the images get the
+// exact same treatment ImageCache::decode gives them at runtime, scaled to
+// --max-size and opaque ones packed as rgb, so the app can use the pixels as
+// they are.
+//
+//   thenews_pack -o thenews.pack --max-size 256 --root src assets/astolfo.jpg ...
+//
+// files are named relative to --root and stored as ":/<name>", their qrc path
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../assetpack.h"
+
+#include <QCoreApplication>
+#include <QImage>
+#include <QString>
+
+namespace {
+
+constexpr std::uint64_t dataAlignment = 64;
+
+std::uint64_t align(std::uint64_t offset) {
+    return (offset + dataAlignment - 1) / dataAlignment * dataAlignment;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    std::string output;
+    std::string root = ".";
+    int maxDimension = 256;
+    bool packRgb = true;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg == "--root" && i + 1 < argc) {
+            root = argv[++i];
+        } else if (arg == "--max-size" && i + 1 < argc) {
+            maxDimension = std::atoi(argv[++i]);
+        } else if (arg == "--rgba") {
+            packRgb = false;
+        } else {
+            files.emplace_back(arg);
+        }
+    }
+    if (output.empty() || files.empty()) {
+        std::cerr << "usage: thenews_pack -o OUT [--root DIR] [--max-size PX] [--rgba] FILE...\n";
+        return 1;
+    }
+
+    std::vector<AssetPackEntry> entries;
+    std::vector<QImage> images;
+    std::uint64_t offset = align(sizeof(AssetPackHeader) + files.size() * sizeof(AssetPackEntry));
+
+    for (const auto &file : files) {
+        std::string name = ":/" + file;
+        if (name.size() >= sizeof(AssetPackEntry::name)) {
+            std::cerr << "thenews_pack: " << file << ": name too long for the pack\n";
+            return 1;
+        }
+        QImage image(QString::fromStdString(root + "/" + file));
+        if (image.isNull()) {
+            std::cerr << "thenews_pack: cant decode " << file << "\n";
+            return 1;
+        }
+
+        AssetPackEntry entry{};
+        std::memcpy(entry.name, name.c_str(), name.size());
+        entry.originalWidth = image.width();
+        entry.originalHeight = image.height();
+
+        if (maxDimension > 0 && (image.width() > maxDimension || image.height() > maxDimension)) {
+            image = image.scaled(maxDimension, maxDimension, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+        bool rgb = packRgb && !image.hasAlphaChannel();
+        image = image.convertToFormat(rgb ? QImage::Format_RGB888 : QImage::Format_RGBA8888);
+
+        entry.width = image.width();
+        entry.height = image.height();
+        entry.rowstride = static_cast<std::int32_t>(image.bytesPerLine());
+        entry.hasAlpha = rgb ? 0 : 1;
+        entry.channels = rgb ? 3 : 4;
+        entry.bitsPerSample = 8;
+        entry.offset = offset;
+        entry.size = static_cast<std::uint64_t>(image.sizeInBytes());
+        offset = align(offset + entry.size);
+
+        entries.push_back(entry);
+        images.push_back(std::move(image));
+    }
+
+    AssetPackHeader header{};
+    std::memcpy(header.magic, assetPackMagic, sizeof(assetPackMagic));
+    header.version = assetPackVersion;
+    header.count = static_cast<std::uint32_t>(entries.size());
+    header.maxDimension = maxDimension;
+    header.flags = packRgb ? assetPackOpaqueAsRgb : 0;
+
+    // running copies of the app have the old pack mmapped, truncating it under
+    // them would turn their pixels into SIGBUS. write a new file and rename it
+    // over the old one, they keep the old inode until they exit
+    std::string temporary = output + ".tmp";
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(AssetPackEntry)));
+    for (std::size_t i = 0; i < entries.size(); i++) {
+        // pad up to the entry's offset
+        std::uint64_t position = static_cast<std::uint64_t>(out.tellp());
+        std::string padding(entries[i].offset - position, '\0');
+        out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        out.write(reinterpret_cast<const char *>(images[i].constBits()), static_cast<std::streamsize>(entries[i].size));
+    }
+    out.close();
+    if (!out) {
+        std::cerr << "thenews_pack: cant write " << temporary << "\n";
+        std::remove(temporary.c_str());
+        return 1;
+    }
+    if (std::rename(temporary.c_str(), output.c_str()) != 0) {
+        std::cerr << "thenews_pack: cant move " << temporary << " to " << output << ": " << std::strerror(errno) << "\n";
+        std::remove(temporary.c_str());
+        return 1;
+    }
+
+    std::cout << "thenews_pack: " << entries.size() << " images, " << offset / 1024 << " KiB -> " << output << "\n";
+    return 0;
+}